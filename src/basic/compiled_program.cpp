@@ -0,0 +1,100 @@
+#include "compiled_program.h"
+#include "shared_program.h"
+
+#include <type_traits>
+
+namespace {
+    // The value stack and the argument list of the running thread.
+    thread_local DataList value_stack;
+    thread_local DataList arg_list;
+}
+
+// Append the instructions of "program" and return the max depth of the stack while running them.
+template<class T>
+int CompiledProgram::append(T *program) {
+    // Parameters and constants are cheaper to evaluate than to look up.
+    int lookup_pos = -1;
+    if constexpr (std::is_same<T, SharedProgram>::value) {
+        if (!program->sub_list.empty()) {
+            lookup_pos = code.size();
+            code.emplace_back(OP_LOOKUP, 0, program->semantics, program->id);
+        }
+    }
+    int depth = 0;
+    for (int i = 0; i < program->sub_list.size(); ++i) {
+        depth = std::max(depth, i + append(program->sub_list[i]));
+    }
+    auto* semantics = program->semantics;
+    if (auto* param_semantics = dynamic_cast<ParamSemantics*>(semantics)) {
+        code.emplace_back(OP_PARAM, param_semantics->getId(), semantics);
+    } else if (auto* const_semantics = dynamic_cast<ConstSemantics*>(semantics)) {
+        code.emplace_back(OP_CONST, int(const_list.size()), semantics);
+        const_list.push_back(const_semantics->value);
+    } else {
+        int node_id = lookup_pos == -1 ? -1 : code[lookup_pos].node_id;
+        if (lookup_pos != -1) code[lookup_pos].arg = code.size();
+        code.emplace_back(OP_CALL, int(program->sub_list.size()), semantics, node_id);
+    }
+    return std::max(depth, 1);
+}
+
+CompiledProgram::CompiledProgram(Program *program) {
+    max_depth = append(program);
+}
+
+CompiledProgram::CompiledProgram(SharedProgram *program) {
+    max_depth = append(program);
+}
+
+template<bool is_cached>
+Data CompiledProgram::execute(GlobalInfo *inp, int example_id, EvaluationCache *cache) const {
+    auto* param_info = dynamic_cast<ParamInfo*>(inp);
+    auto& stack = value_stack;
+    size_t base = stack.size();
+    stack.reserve(base + max_depth);
+    for (int pc = 0; pc < code.size(); ++pc) {
+        auto& instruction = code[pc];
+        switch (instruction.op) {
+            case OP_PARAM: {
+#ifdef DEBUG
+                assert(param_info != nullptr);
+#endif
+                stack.push_back((*param_info)[instruction.arg]);
+                break;
+            }
+            case OP_CONST: {
+                stack.push_back(const_list[instruction.arg]);
+                break;
+            }
+            case OP_CALL: {
+                int n = instruction.arg;
+                arg_list.assign(std::make_move_iterator(stack.end() - n), std::make_move_iterator(stack.end()));
+                stack.resize(stack.size() - n);
+                stack.push_back(instruction.semantics->run(arg_list, inp));
+                if (is_cached && instruction.node_id != -1) cache->insert(instruction.node_id, example_id, stack.back());
+                break;
+            }
+            case OP_LOOKUP: {
+                if (!is_cached) break;
+                Data result;
+                if (cache->lookup(instruction.node_id, example_id, result)) {
+                    stack.push_back(std::move(result));
+                    pc = instruction.arg;
+                }
+                break;
+            }
+        }
+    }
+    arg_list.clear();
+    Data result = std::move(stack.back());
+    stack.pop_back();
+    return result;
+}
+
+Data CompiledProgram::run(GlobalInfo *inp) const {
+    return execute<false>(inp, 0, nullptr);
+}
+
+Data CompiledProgram::run(GlobalInfo *inp, int example_id, EvaluationCache *cache) const {
+    return execute<true>(inp, example_id, cache);
+}
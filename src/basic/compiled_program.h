@@ -0,0 +1,52 @@
+#ifndef L2S_COMPILED_PROGRAM_H
+#define L2S_COMPILED_PROGRAM_H
+
+#include "program.h"
+#include "evaluation_cache.h"
+
+class SharedProgram;
+
+// A program compiled into a flat list of instructions in post-order.
+// It is evaluated with a value stack instead of walking the AST: parameters and constants are pushed directly, and
+// an operator moves its operands into a reusable argument list before calling "Semantics::run". Both buffers are kept
+// per thread, so evaluating a program on many examples allocates nothing besides the values themselves.
+// A program compiled from a "SharedProgram" can also be run with an "EvaluationCache": every operator node is preceded
+// by a lookup of its output, which skips the instructions of the node on a hit.
+class CompiledProgram {
+public:
+    enum OpCode {
+        OP_PARAM,   // Push the value of a parameter.
+        OP_CONST,   // Push a constant.
+        OP_CALL,    // Pop the operands and push the result of an operator.
+        OP_LOOKUP   // Push the recorded output of a node and jump to the instruction after its "OP_CALL", if any.
+    };
+    struct Instruction {
+        OpCode op;
+        // The parameter id for "OP_PARAM", the index in "const_list" for "OP_CONST", and the number of operands for
+        // "OP_CALL", and the index of the "OP_CALL" of the node for "OP_LOOKUP".
+        int arg;
+        Semantics* semantics;
+        // The id of the "SharedProgram" node computed by an "OP_CALL" or looked up by an "OP_LOOKUP", or -1.
+        int node_id;
+        Instruction(OpCode _op, int _arg, Semantics* _semantics, int _node_id = -1):
+            op(_op), arg(_arg), semantics(_semantics), node_id(_node_id) {}
+    };
+private:
+    std::vector<Instruction> code;
+    DataList const_list;
+    int max_depth;
+
+    template<class T> int append(T* program);
+    template<bool is_cached> Data execute(GlobalInfo* inp, int example_id, EvaluationCache* cache) const;
+public:
+    CompiledProgram(Program* program);
+    CompiledProgram(SharedProgram* program);
+    int size() const {return code.size();}
+    // Run the program with the values of parameters stored in "inp". Thread-safe.
+    Data run(GlobalInfo* inp) const;
+    // Run the program on the example "example_id", whose parameters are stored in "inp". The outputs of operator nodes
+    // are looked up in and recorded into "cache". Thread-safe.
+    Data run(GlobalInfo* inp, int example_id, EvaluationCache* cache) const;
+};
+
+#endif //L2S_COMPILED_PROGRAM_H
@@ -3,10 +3,30 @@
 const std::string config::KSourcePath = SOURCEPATH;
 const std::string config::KParserMainPath = KSourcePath + "/parser/python/main.py";
 double config::KDefaultP = 0.001;
-SpecType global::spec_type = S_NONE;
-StringInfo* global::string_info = new StringInfo();
-int global::KIntMax = 20;
-int global::KIntMin = -5;
-int global::KContextDepth = 2;
-bool global::isMatrix = false;
-int global::KMaxDim = 3;
\ No newline at end of file
+int config::KReplaceWitnessLimit = 1000;
+
+namespace {
+    thread_local SolverContext default_context;
+}
+
+thread_local SolverContext* global::context = &default_context;
+ThreadPool* global::thread_pool = nullptr;
+
+void SolverContext::copyTaskFrom(const SolverContext &context) {
+    spec_type = context.spec_type;
+    *string_info = *context.string_info;
+    KIntMax = context.KIntMax;
+    KIntMin = context.KIntMin;
+    KContextDepth = context.KContextDepth;
+    isMatrix = context.isMatrix;
+    KMaxDim = context.KMaxDim;
+    KDefaultP = context.KDefaultP;
+}
+
+SolverContextGuard::SolverContextGuard(SolverContext *context): previous(global::context) {
+    global::context = context;
+}
+
+SolverContextGuard::~SolverContextGuard() {
+    global::context = previous;
+}
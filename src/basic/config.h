@@ -4,9 +4,12 @@
 #include <algorithm>
 #include "specification.h"
 #include "semantics.h"
+#include "data_pool.h"
+#include "thread_pool.h"
 
 #include <unordered_set>
 #include <unordered_map>
+#include <memory>
 
 enum SpecType {
     S_ORACLE,   //Abandoned.
@@ -17,9 +20,15 @@ enum SpecType {
 namespace config {
     extern const std::string KSourcePath;   // The path of the source code.
     extern const std::string KParserMainPath;   // The path of the client parser for the string domain.
-    extern double KDefaultP;    // Default probability for an operator.
+    extern double KDefaultP;    // Default probability for an operator in new contexts.
+    extern int KReplaceWitnessLimit;    // The max number of witnesses of str.replace with an empty replacement.
 }
 
+class ShapeTable;
+class StringIndex;
+class ConstantClassifier;
+class StringRelation;
+
 class StringInfo : public ParamInfo{
 public:
     virtual std::string getName() {return "StringInfo";}
@@ -27,7 +36,11 @@ public:
     DataList const_list;    // All possible constants.
     std::unordered_set<std::string> const_set;  // The set of all possible contants.
     std::unordered_map<std::string, std::string> const_cache;   // Cache the abstracted name of constants.
+    std::shared_ptr<const ConstantClassifier> const_classifier; // The abstracted names of all string constants.
     std::vector<int> int_const; // All possible integer constants.
+    std::shared_ptr<const StringIndex> string_index; // The substring index of all strings in the string domain.
+    std::shared_ptr<const StringRelation> string_relation; // The relations among strings on the current example.
+    std::shared_ptr<const ShapeTable> shape_table; // Possible shapes of matrices in the matrix domain.
     Specification* spec;
     void setInp(const DataList& _inp) {
         param_value.clear();
@@ -40,23 +53,61 @@ public:
         const_list.clear();
         const_set.clear();
         const_cache.clear();
+        string_index = nullptr;
+        const_classifier = nullptr;
+        string_relation = nullptr;
+        shape_table = nullptr;
     }
 };
 
-namespace global {
+// The state of a synthesis task. Tasks with different contexts are independent and can be solved at the same time on
+// different threads.
+class SolverContext {
+public:
     // The type of the specification.
-    extern SpecType spec_type;
+    SpecType spec_type = S_NONE;
     // Global info of a synthesis task in the string domain. It will be used by witness functions.
-    extern StringInfo* string_info;
+    StringInfo* string_info;
     // The range of possible integer values in the result program.
-    extern int KIntMax;
-    extern int KIntMin;
+    int KIntMax = 20;
+    int KIntMin = -5;
     // The depth of the n-gram model.
-    extern int KContextDepth;
+    int KContextDepth = 2;
     // Whether the benchmark is in the matrix domain.
-    extern bool isMatrix;
+    bool isMatrix = false;
     // The max number of dimensions in the result program.
-    extern int KMaxDim;
+    int KMaxDim = 3;
+    // Default probability for an operator, initialized with "config::KDefaultP".
+    double KDefaultP;
+    // The table interning all values appearing in the VSA.
+    DataPool* data_pool;
+    SolverContext(): string_info(new StringInfo()), KDefaultP(config::KDefaultP), data_pool(new DataPool()) {}
+    SolverContext(const SolverContext&) = delete;
+    SolverContext& operator = (const SolverContext&) = delete;
+    // Share the task loaded in "context": its specification type, the bounds of values and a copy of its string info.
+    // The data pool is not shared.
+    void copyTaskFrom(const SolverContext& context);
+    ~SolverContext() {
+        delete string_info;
+        delete data_pool;
+    }
+};
+
+// Make "context" the context of the current thread during the lifetime of the guard.
+class SolverContextGuard {
+    SolverContext* previous;
+public:
+    SolverContextGuard(SolverContext* context);
+    ~SolverContextGuard();
+};
+
+namespace global {
+    // The context of the task solved by the current thread. Each thread starts with a context of its own, and
+    // iterations of "ThreadPool::parallelFor" run in the context of the caller.
+    extern thread_local SolverContext* context;
+    // The threads used to evaluate witness functions. "nullptr" represents the sequential mode. It is shared by all
+    // tasks.
+    extern ThreadPool* thread_pool;
 }
 
 #endif //L2S_CNFIG_H
@@ -0,0 +1,103 @@
+#include "constant_classifier.h"
+
+#include <queue>
+
+void ConstantClassifier::insert(std::string_view value, int const_id) {
+    int now = 0;
+    for (char c: value) {
+        int& next = node_list[now].next[(unsigned char)(c)];
+        if (next == -1) {
+            next = node_list.size();
+            node_list.emplace_back();
+        }
+        now = node_list[now].next[(unsigned char)(c)];
+    }
+    node_list[now].const_list.push_back(const_id);
+}
+
+void ConstantClassifier::buildFailLinks() {
+    std::queue<int> Q;
+    node_list[0].output = node_list[0].const_list.empty() ? -1 : 0;
+    for (int& next: node_list[0].next) {
+        if (next == -1) {
+            next = 0;
+        } else {
+            node_list[next].fail = 0;
+            Q.push(next);
+        }
+    }
+    while (!Q.empty()) {
+        int now = Q.front(); Q.pop();
+        auto& node = node_list[now];
+        node.output = node.const_list.empty() ? node_list[node.fail].output : now;
+        for (int c = 0; c < 256; ++c) {
+            int next = node.next[c];
+            if (next == -1) {
+                node.next[c] = node_list[node.fail].next[c];
+            } else {
+                node_list[next].fail = node_list[node.fail].next[c];
+                Q.push(next);
+            }
+        }
+    }
+}
+
+void ConstantClassifier::scan(std::string_view text, int stamp, std::vector<int> &occur_list) const {
+    auto record = [&](int now) {
+        for (int pos = node_list[now].output; pos != -1 && occur_list[node_list[pos].const_list[0]] != stamp;
+             pos = node_list[node_list[pos].fail].output) {
+            for (int const_id: node_list[pos].const_list) occur_list[const_id] = stamp;
+            if (pos == 0) break;
+        }
+    };
+    int now = 0;
+    record(now);
+    for (char c: text) {
+        now = node_list[now].next[(unsigned char)(c)];
+        record(now);
+    }
+}
+
+ConstantClassifier::ConstantClassifier(const DataList &const_list, const std::vector<Example*>& example_space) {
+    node_list.emplace_back();
+    std::unordered_map<Data, int, DataHash> id_map;
+    for (auto& value: const_list) {
+        if (value.getType() != TSTRING || id_map.find(value) != id_map.end()) continue;
+        int id = id_map.size();
+        id_map[value] = id;
+        insert(value.getString(), id);
+    }
+    buildFailLinks();
+    int const_num = id_map.size();
+    std::vector<int> inp_occur(const_num, -1), oup_occur(const_num, -1);
+    std::vector<int> inp_num(const_num, 0), oup_num(const_num, 0);
+    for (int example_id = 0; example_id < example_space.size(); ++example_id) {
+        auto* example = example_space[example_id];
+        for (auto& param: example->inp) {
+            if (param.getType() == TSTRING) scan(param.getString(), example_id, inp_occur);
+        }
+        if (example->oup.getType() == TSTRING) scan(example->oup.getString(), example_id, oup_occur);
+        for (int i = 0; i < const_num; ++i) {
+            inp_num[i] += inp_occur[i] == example_id;
+            oup_num[i] += oup_occur[i] == example_id;
+        }
+    }
+    for (auto& info: id_map) {
+        type_map[info.first] = getTypeName(inp_num[info.second], oup_num[info.second]);
+    }
+}
+
+const std::string * ConstantClassifier::getType(const Data &value) const {
+    auto it = type_map.find(value);
+    if (it == type_map.end()) return nullptr;
+    return &(it->second);
+}
+
+std::string ConstantClassifier::getTypeName(int inp_num, int oup_num) {
+    std::string result;
+    if (inp_num > 0 && oup_num > 0) result = "SomeInOutput";
+    else if (inp_num > 0) result = "SomeInput";
+    else if (oup_num > 0) result = "SomeOutput";
+    else result = "None";
+    return "Constant@" + result;
+}
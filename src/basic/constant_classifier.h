@@ -0,0 +1,40 @@
+#ifndef L2S_CONSTANT_CLASSIFIER_H
+#define L2S_CONSTANT_CLASSIFIER_H
+
+#include "data.h"
+#include "specification.h"
+
+#include <array>
+#include <unordered_map>
+
+// The types of string constants used as features by the prediction model, e.g., "Constant@SomeInput" for constants
+// occurring in the input of some example. All constants of a task are classified together: an Aho-Corasick automaton
+// over the constants is built, and each example string is scanned once.
+class ConstantClassifier {
+    struct DataHash {
+        size_t operator () (const Data& data) const {return data.hash();}
+    };
+    struct Node {
+        std::array<int, 256> next;
+        int fail = 0;
+        // The nearest node on the fail chain (including this node) where some constant ends, or -1.
+        int output = -1;
+        std::vector<int> const_list;
+        Node() {next.fill(-1);}
+    };
+    std::vector<Node> node_list;
+    std::unordered_map<Data, std::string, DataHash> type_map;
+
+    void insert(std::string_view value, int const_id);
+    void buildFailLinks();
+    // Record the constants occurring in "text" by setting their items in "occur_list" to "stamp".
+    void scan(std::string_view text, int stamp, std::vector<int>& occur_list) const;
+public:
+    ConstantClassifier(const DataList& const_list, const std::vector<Example*>& example_space);
+    // The type of a constant, or nullptr if it is not classified.
+    const std::string* getType(const Data& value) const;
+    int size() const {return type_map.size();}
+    static std::string getTypeName(int inp_num, int oup_num);
+};
+
+#endif //L2S_CONSTANT_CLASSIFIER_H
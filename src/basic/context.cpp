@@ -6,25 +6,29 @@
 #include <fstream>
 #include <sstream>
 #include <json/json.h>
+#include <cmath>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
-void ContextInfoMap::setContextInfo(Context* ctx, const ContextInfo &info) {
-    std::string context_string = ctx->encodeContext();
-#ifdef DEBUG
-    assert(pos_map.count(context_string) == 0);
-#endif
-    pos_map[context_string] = info_list.size();
-    info_list.push_back(info);
+std::string_view ContextInfo::getName(int pos) const {
+    return info_map->getString(info_map->operator_list[info_map->record_list[begin + pos].operator_id]);
 }
 
-ContextInfo* ContextInfoMap::getContextInfo(Context *ctx) {
-    std::string context_string = ctx->encodeContext();
-    if (pos_map.count(context_string) == 0) {
-        pos_map[context_string] = info_list.size();
-        info_list.push_back({});
-        return &info_list[info_list.size() - 1];
-    }
-    int pos = pos_map[context_string];
-    return &info_list[pos];
+double ContextInfo::getProbability(int pos) const {
+    return std::exp(info_map->record_list[begin + pos].log_p);
+}
+
+ContextInfo ContextInfoMap::getContextInfo(Context *ctx) const {
+    std::string key = ctx->encodeContext();
+    auto* context_end = context_list + header->context_num;
+    auto* it = std::lower_bound(context_list, context_end, key,
+            [this](const model_format::ContextRecord& record, const std::string& key) {
+        return getString(record.key) < key;
+    });
+    if (it == context_end || getString(it->key) != key) return ContextInfo(this, 0, 0);
+    return ContextInfo(this, it->begin, it->end);
 }
 
 #include <iostream>
@@ -54,44 +58,138 @@ std::string TopDownContext::encodeContext() const {
     return res + "}";
 }
 
-ContextInfoMap::ContextInfoMap(std::string json_file_name) {
+namespace {
+    size_t getImageSize(const model_format::Header& header) {
+        return sizeof(model_format::Header) + sizeof(model_format::Record) * header.record_num +
+               sizeof(model_format::ContextRecord) * header.context_num +
+               sizeof(model_format::StringRef) * header.operator_num + header.char_num;
+    }
+}
+
+void ContextInfoMap::loadImage(const char *image, size_t size) {
+    assert(size >= sizeof(model_format::Header));
+    header = reinterpret_cast<const model_format::Header*>(image);
+    assert(header->version == model_format::KVersion && size == getImageSize(*header));
+    record_list = reinterpret_cast<const model_format::Record*>(image + sizeof(model_format::Header));
+    context_list = reinterpret_cast<const model_format::ContextRecord*>(record_list + header->record_num);
+    operator_list = reinterpret_cast<const model_format::StringRef*>(context_list + header->context_num);
+    char_pool = reinterpret_cast<const char*>(operator_list + header->operator_num);
+    context_depth = header->context_depth;
+}
+
+void ContextInfoMap::loadJson(const std::string& json_file_name) {
     Json::Reader reader;
     Json::Value root;
 
     std::string json_string = util::loadStringFromFile(json_file_name);
     assert(reader.parse(json_string, root));
+    std::vector<std::pair<std::string, std::vector<std::pair<std::string, double>>>> info_list;
+    int depth = 2;
     for (auto& context_info_node: root) {
         auto& context_node = context_info_node["context"];
         std::vector<std::string> context_list;
         for (auto& context_name: context_node) {
             context_list.push_back(context_name.asString());
         }
-        global::KContextDepth = context_list.size();
-        auto* context = new TopDownContext(context_list);
-        ContextInfo info_list;
+        depth = context_list.size();
+        std::vector<std::pair<std::string, double>> rule_list;
         for (auto& rule: context_info_node["rule"]) {
             std::string term = rule["term"].asString();
             double probability = rule["p"].asDouble();
-            info_list.push_back(std::make_pair(term, probability));
+            rule_list.push_back(std::make_pair(term, probability));
         }
-        std::sort(info_list.begin(), info_list.end(),
+        std::sort(rule_list.begin(), rule_list.end(),
                   [](std::pair<std::string, double> x, std::pair<std::string, double> y){
                       return x.second > y.second;
                   });
-        setContextInfo(context, info_list);
+        info_list.emplace_back(TopDownContext(context_list).encodeContext(), rule_list);
+    }
+    std::sort(info_list.begin(), info_list.end(), [](const auto& x, const auto& y) {return x.first < y.first;});
+
+    std::vector<model_format::Record> records;
+    std::vector<model_format::ContextRecord> contexts;
+    std::vector<model_format::StringRef> operators;
+    std::string chars;
+    std::unordered_map<std::string, int> operator_map;
+    auto insert_string = [&](const std::string& s) {
+        model_format::StringRef ref = {uint32_t(chars.length()), uint32_t(s.length())};
+        chars += s;
+        return ref;
+    };
+#ifdef DEBUG
+    assert(std::adjacent_find(info_list.begin(), info_list.end(),
+            [](const auto& x, const auto& y) {return x.first == y.first;}) == info_list.end());
+#endif
+    for (auto& info: info_list) {
+        model_format::ContextRecord context = {insert_string(info.first), uint32_t(records.size()), 0};
+        for (auto& rule: info.second) {
+            auto it = operator_map.find(rule.first);
+            if (it == operator_map.end()) {
+                it = operator_map.insert({rule.first, operators.size()}).first;
+                operators.push_back(insert_string(rule.first));
+            }
+            records.push_back({uint32_t(it->second), 0, std::log(rule.second)});
+        }
+        context.end = records.size();
+        contexts.push_back(context);
+    }
+
+    model_format::Header model_header;
+    std::copy(model_format::KMagic, model_format::KMagic + 8, model_header.magic);
+    model_header.version = model_format::KVersion;
+    model_header.context_depth = depth;
+    model_header.context_num = contexts.size();
+    model_header.record_num = records.size();
+    model_header.operator_num = operators.size();
+    model_header.char_num = chars.length();
+    buffer.reserve(getImageSize(model_header));
+    buffer.append(reinterpret_cast<const char*>(&model_header), sizeof(model_header));
+    buffer.append(reinterpret_cast<const char*>(records.data()), sizeof(model_format::Record) * records.size());
+    buffer.append(reinterpret_cast<const char*>(contexts.data()), sizeof(model_format::ContextRecord) * contexts.size());
+    buffer.append(reinterpret_cast<const char*>(operators.data()), sizeof(model_format::StringRef) * operators.size());
+    buffer += chars;
+    loadImage(buffer.data(), buffer.size());
+}
+
+ContextInfoMap::ContextInfoMap(const std::string& file_name) {
+    int fd = open(file_name.c_str(), O_RDONLY);
+    assert(fd != -1);
+    struct stat file_stat;
+    fstat(fd, &file_stat);
+    size_t size = file_stat.st_size;
+    char magic[8] = {};
+    if (size >= sizeof(model_format::Header) && pread(fd, magic, 8, 0) == 8 &&
+        std::equal(magic, magic + 8, model_format::KMagic)) {
+        mapped_image = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        assert(mapped_image != MAP_FAILED);
+        mapped_size = size;
+        loadImage(static_cast<const char*>(mapped_image), size);
+    } else {
+        loadJson(file_name);
     }
+    close(fd);
+    global::context->KContextDepth = context_depth;
+}
+
+ContextInfoMap::~ContextInfoMap() {
+    if (mapped_image != nullptr) munmap(mapped_image, mapped_size);
 }
 
-void ContextInfoMap::print() {
-    for (auto& pos_pair: pos_map) {
-        std::string context_string = pos_pair.first;
-        int pos = pos_pair.second;
-        ContextInfo& context_info = info_list[pos];
-        printf("%s => ", context_string.c_str());
-        for (int i = 0; i < context_info.size(); ++i) {
-            if (i) printf(", ");
-            printf("%s: %.3lf", context_info[i].first.c_str(), context_info[i].second);
+void ContextInfoMap::save(const std::string &file_name) const {
+    std::ofstream oup(file_name, std::ios::binary);
+    oup.write(reinterpret_cast<const char*>(header), getImageSize(*header));
+    assert(oup.good());
+}
+
+void ContextInfoMap::print() const {
+    for (int i = 0; i < header->context_num; ++i) {
+        auto& context = context_list[i];
+        ContextInfo context_info(this, context.begin, context.end);
+        printf("%s => ", std::string(getString(context.key)).c_str());
+        for (int j = 0; j < context_info.size(); ++j) {
+            if (j) printf(", ");
+            printf("%s: %.3lf", std::string(context_info.getName(j)).c_str(), context_info.getProbability(j));
         }
         puts("");
     }
-}
\ No newline at end of file
+}
@@ -5,11 +5,15 @@
 #include <algorithm>
 #include <unordered_map>
 #include <cassert>
+#include <cstdint>
+#include <string>
+#include <string_view>
 
 // An abstract class representing the context model.
 class Context {
 public:
     virtual std::string encodeContext() const = 0;
+    virtual ~Context() = default;
 };
 
 // Contexts in an n-gram model.
@@ -22,18 +26,74 @@ public:
     virtual std::string encodeContext() const;
 };
 
-typedef std::vector<std::pair<std::string, double>> ContextInfo;
+class ContextInfoMap;
 
-// Store the probability for each possible operator under each possible context.
-class ContextInfoMap {
+// The probabilities of operators under a context, in the decreasing order of probabilities. It is a view of the
+// records stored in a ContextInfoMap.
+class ContextInfo {
+    const ContextInfoMap* info_map;
+    int begin, end;
 public:
-    std::vector<ContextInfo> info_list;
-    std::unordered_map<std::string, int> pos_map;
-    void setContextInfo(Context* ctx, const ContextInfo& info);
-    ContextInfo* getContextInfo(Context* ctx);
-    ContextInfoMap(std::string json_file_name);
-    void print();
+    ContextInfo(const ContextInfoMap* _info_map, int _begin, int _end): info_map(_info_map), begin(_begin), end(_end) {}
+    int size() const {return end - begin;}
+    std::string_view getName(int pos) const;
+    double getProbability(int pos) const;
 };
 
+// The layout of a model in the binary format. A model file consists of a header followed by the records, the
+// contexts sorted by their keys, the operator table and the pool of characters. Operators are interned, i.e., a
+// record refers to its operator by the index in the operator table, and probabilities are stored as logarithms.
+// Numbers are stored in the byte order of the machine producing the file.
+namespace model_format {
+    const char KMagic[8] = {'L', '2', 'S', 'M', 'O', 'D', 'E', 'L'};
+    const uint32_t KVersion = 1;
+    struct Header {
+        char magic[8];
+        uint32_t version, context_depth, context_num, record_num, operator_num, char_num;
+    };
+    struct StringRef {
+        uint32_t offset, length;
+    };
+    struct ContextRecord {
+        StringRef key;
+        uint32_t begin, end;
+    };
+    struct Record {
+        uint32_t operator_id, padding;
+        double log_p;
+    };
+}
+
+// Store the probability for each possible operator under each possible context. A model is either a json file
+// produced by the python trainer in "train/python", which is parsed and converted into the binary format in memory,
+// or a file in the binary format, which is mapped into memory without parsing.
+class ContextInfoMap {
+    // The model in the binary format: either "buffer" or a mapped file.
+    std::string buffer;
+    void* mapped_image = nullptr;
+    size_t mapped_size = 0;
+    const model_format::Header* header;
+    const model_format::Record* record_list;
+    const model_format::ContextRecord* context_list;
+    const model_format::StringRef* operator_list;
+    const char* char_pool;
+    std::string_view getString(const model_format::StringRef& ref) const {return {char_pool + ref.offset, ref.length};}
+    void loadImage(const char* image, size_t size);
+    void loadJson(const std::string& json_file_name);
+    friend class ContextInfo;
+public:
+    // The depth of contexts in the model. Loading a model also sets the depth of "global::context".
+    int context_depth = 2;
+    // The probabilities under a context, or an empty list if the context does not occur in the model. The map is
+    // not modified, so that it can be shared by tasks solved at the same time.
+    ContextInfo getContextInfo(Context* ctx) const;
+    int size() const {return header->context_num;}
+    // The format of "file_name" is decided by its first bytes.
+    ContextInfoMap(const std::string& file_name);
+    ~ContextInfoMap();
+    // Write the model in the binary format.
+    void save(const std::string& file_name) const;
+    void print() const;
+};
 
 #endif //L2S_CONTEXT_H
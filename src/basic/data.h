@@ -4,69 +4,138 @@
 #include "value.h"
 
 #include <cassert>
+#include <functional>
+#include <memory>
+#include <algorithm>
+#include <string>
 #include <vector>
 
 #include "json/json.h"
 
 // A common class representing all possible values.
 // If a new type of values is used, this type must be registered in this class.
+// Integers and booleans are stored inline. Strings and matrices are immutable and shared by all copies of a "Data",
+// so copying or moving a "Data" never allocates. A string is a span (offset, length) of a shared "Text", and thus
+// taking a substring never copies characters either.
 class Data {
+    Type type;
+    union {
+        int int_value;
+        bool bool_value;
+        struct {
+            int offset, length;
+        } span;
+    };
+    // The text of a string, or the matrix of this value.
+    std::shared_ptr<const void> object;
+
+    const Text& getText() const {return *static_cast<const Text*>(object.get());}
+    Data(const Data& text_data, int offset, int length): type(TSTRING), object(text_data.object) {
+        span.offset = offset; span.length = length;
+    }
 public:
-    Value* value;
-    Type getType() const {return value->getType();}
-    Data(Value* _value): value(_value) {}
+    Type getType() const {return type;}
 
-    Data(): value(nullptr) {}
-    Data(int _value): value(new IntValue(_value)) {}
-    Data(bool _value): value(new BoolValue(_value)) {}
-    Data(const Data& _data): value(_data.value->copy()) {}
-    ~Data() {if (value) delete value; value = nullptr;}
+    Data(): type(TINT), int_value(0) {}
+    Data(int _value): type(TINT), int_value(_value) {}
+    Data(bool _value): type(TBOOL), bool_value(_value) {}
+    Data(const char* _value): Data(std::string(_value)) {}
+    Data(std::string _value): type(TSTRING), object(std::make_shared<const Text>(std::move(_value))) {
+        span.offset = 0; span.length = getText().value.size();
+    }
+    Data(Matrix _value): type(TMATRIX), int_value(0), object(std::make_shared<const Matrix>(std::move(_value))) {}
 
     std::string toString() const {
-        switch (value->getType()) {
+        switch (type) {
             case TINT: return std::to_string(getInt());
             case TBOOL: return getBool() ? "True" : "False";
-            case TSTRING: return "\"" + getString() + "\"";
-            case TMATRIX: return dynamic_cast<MatrixValue*>(value)->toString();
+            case TSTRING: return "\"" + std::string(getString()) + "\"";
+            case TMATRIX: return getMatrix().toString();
         }
     }
 
     int getInt() const {
 #ifdef DEBUG
-        assert(value->getType() == TINT);
+        assert(type == TINT);
 #endif
-        return dynamic_cast<IntValue*>(value)->getValue();
+        return int_value;
     }
 
     bool getBool() const {
 #ifdef DEBUG
-        assert(value->getType() == TBOOL);
+        assert(type == TBOOL);
 #endif
-        return dynamic_cast<BoolValue*>(value)->getValue();
+        return bool_value;
     }
 
-    std::string getString() const {
+    std::string_view getString() const {
 #ifdef DEBUG
-        assert(value->getType() == TSTRING);
+        assert(type == TSTRING);
 #endif
-        return dynamic_cast<StringValue*>(value)->getValue();
+        return std::string_view(getText().value).substr(span.offset, span.length);
     };
 
-    Matrix getMatrix() const {
+    // The string "getString().substr(pos, length)". It shares the text of this string.
+    Data getSubstring(int pos, int length) const {
+#ifdef DEBUG
+        assert(type == TSTRING && pos >= 0 && pos <= span.length);
+#endif
+        return Data(*this, span.offset + pos, std::min(length, span.length - pos));
+    }
+
+    // The concatenation of two strings. No character is copied if "data" starts right after this string in the
+    // same text.
+    Data concat(const Data& data) const {
+        if (object == data.object && span.offset + span.length == data.span.offset) {
+            return Data(*this, span.offset, span.length + data.span.length);
+        }
+        std::string result;
+        result.reserve(span.length + data.span.length);
+        result.append(getString());
+        result.append(data.getString());
+        return Data(std::move(result));
+    }
+
+    const Matrix& getMatrix() const {
 #ifdef DEBUG
-        assert(value->getType() == TMATRIX);
+        assert(type == TMATRIX);
 #endif
-        return dynamic_cast<MatrixValue*>(value)->getValue();
+        return *static_cast<const Matrix*>(object.get());
     }
 
     bool operator == (const Data& data) const {
-        if (getType() != data.getType()) return false;
-        switch (getType()) {
-            case TINT: return getInt() == data.getInt();
-            case TBOOL: return getBool() == data.getBool();
-            case TSTRING: return getString() == data.getString();
-            case TMATRIX: return getMatrix() == data.getMatrix();
+        if (type != data.type) return false;
+        switch (type) {
+            case TINT: return int_value == data.int_value;
+            case TBOOL: return bool_value == data.bool_value;
+            case TSTRING: {
+                if (span.length != data.span.length) return false;
+                if (object == data.object && span.offset == data.span.offset) return true;
+                if (getText().getHash(span.offset, span.length) != data.getText().getHash(data.span.offset, data.span.length)) {
+                    return false;
+                }
+                return getString() == data.getString();
+            }
+            case TMATRIX: return object == data.object || getMatrix() == data.getMatrix();
+        }
+    }
+
+    // A hash value consistent with "==". It never copies the underlying value.
+    size_t hash() const {
+        switch (type) {
+            case TINT: return std::hash<int>()(int_value) * 4 + TINT;
+            case TBOOL: return size_t(bool_value) * 4 + TBOOL;
+            case TSTRING: return getText().getHash(span.offset, span.length) * 4 + TSTRING;
+            case TMATRIX: {
+                auto& matrix = getMatrix();
+                size_t result = matrix.shape.size();
+                for (int dim_size: matrix.shape) result = result * 131 + dim_size;
+                matrix.forEach([&result](int content) {result = result * 1000003 + content;});
+                return result * 4 + TMATRIX;
+            }
         }
+        assert(0);
+        return 0;
     }
 
     bool operator != (const Data& data) const {
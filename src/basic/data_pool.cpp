@@ -0,0 +1,10 @@
+#include "data_pool.h"
+
+int DataPool::getId(const Data &data) {
+    auto it = id_map.find(data);
+    if (it != id_map.end()) return it->second;
+    int id = data_list.size();
+    data_list.push_back(data);
+    id_map.insert(std::make_pair(data, id));
+    return id;
+}
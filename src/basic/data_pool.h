@@ -0,0 +1,26 @@
+#ifndef L2S_DATA_POOL_H
+#define L2S_DATA_POOL_H
+
+#include "data.h"
+
+#include <unordered_map>
+
+// A table interning every distinct "Data" into a dense integer id.
+// Equal values always receive the same id, and thus tuples of ids can be compared and hashed instead of values.
+class DataPool {
+    struct DataHash {
+        size_t operator () (const Data& data) const {return data.hash();}
+    };
+    std::vector<Data> data_list;
+    std::unordered_map<Data, int, DataHash> id_map;
+public:
+    int getId(const Data& data);
+    const Data& getData(int id) const {return data_list[id];}
+    int size() const {return data_list.size();}
+    void clear() {
+        data_list.clear();
+        id_map.clear();
+    }
+};
+
+#endif //L2S_DATA_POOL_H
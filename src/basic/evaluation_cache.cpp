@@ -0,0 +1,66 @@
+#include "evaluation_cache.h"
+
+namespace {
+    const int shard_num = 16;
+}
+
+EvaluationCache::EvaluationCache(size_t capacity): hit_num(0), miss_num(0) {
+    for (int i = 0; i < shard_num; ++i) {
+        shard_list.emplace_back(new Shard());
+    }
+    setCapacity(capacity);
+}
+
+void EvaluationCache::setCapacity(size_t capacity) {
+    shard_capacity = (capacity + shard_num - 1) / shard_num;
+    clear();
+}
+
+EvaluationCache::Shard * EvaluationCache::getShard(long long key) const {
+    return shard_list[std::hash<long long>()(key) % shard_num].get();
+}
+
+bool EvaluationCache::lookup(int program_id, int example_id, Data& result) {
+    if (shard_capacity == 0) return false;
+    long long key = getKey(program_id, example_id);
+    auto* shard = getShard(key);
+    std::lock_guard<std::mutex> guard(shard->lock);
+    auto it = shard->entry_map.find(key);
+    if (it == shard->entry_map.end()) {
+        ++miss_num;
+        return false;
+    }
+    ++hit_num;
+    shard->entry_list.splice(shard->entry_list.begin(), shard->entry_list, it->second);
+    result = it->second->value;
+    return true;
+}
+
+void EvaluationCache::insert(int program_id, int example_id, const Data &value) {
+    if (shard_capacity == 0) return;
+    long long key = getKey(program_id, example_id);
+    auto* shard = getShard(key);
+    std::lock_guard<std::mutex> guard(shard->lock);
+    // Another thread may have evaluated the same program at the same time.
+    if (shard->entry_map.count(key)) return;
+    shard->entry_list.emplace_front(key, value);
+    shard->entry_map[key] = shard->entry_list.begin();
+    if (shard->entry_list.size() > shard_capacity) {
+        shard->entry_map.erase(shard->entry_list.back().key);
+        shard->entry_list.pop_back();
+    }
+}
+
+void EvaluationCache::clear() {
+    for (auto& shard: shard_list) {
+        std::lock_guard<std::mutex> guard(shard->lock);
+        shard->entry_list.clear();
+        shard->entry_map.clear();
+    }
+    hit_num = 0; miss_num = 0;
+}
+
+double EvaluationCache::getHitRate() const {
+    long long total = hit_num + miss_num;
+    return total == 0 ? 0.0 : hit_num * 1.0 / total;
+}
@@ -0,0 +1,47 @@
+#ifndef L2S_EVALUATION_CACHE_H
+#define L2S_EVALUATION_CACHE_H
+
+#include "data.h"
+
+#include <atomic>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+// A bounded table memoizing the outputs of programs on examples, keyed by (the id of a shared program, the id of an
+// example). When the table is full, the least recently used entry is evicted.
+// The table is split into shards with their own locks and LRU lists, so that it can be used by several threads.
+class EvaluationCache {
+    struct Entry {
+        long long key;
+        Data value;
+        Entry(long long _key, const Data& _value): key(_key), value(_value) {}
+    };
+    struct Shard {
+        std::mutex lock;
+        std::list<Entry> entry_list;
+        std::unordered_map<long long, std::list<Entry>::iterator> entry_map;
+    };
+    std::vector<std::unique_ptr<Shard>> shard_list;
+    size_t shard_capacity;
+    std::atomic<long long> hit_num, miss_num;
+
+    static long long getKey(int program_id, int example_id) {
+        return (static_cast<long long>(program_id) << 32) | static_cast<unsigned int>(example_id);
+    }
+    Shard* getShard(long long key) const;
+public:
+    EvaluationCache(size_t capacity);
+    // Limit the number of entries. A capacity of 0 disables the cache.
+    void setCapacity(size_t capacity);
+    // Store the recorded output into "result" and return true, or return false if it is not recorded.
+    bool lookup(int program_id, int example_id, Data& result);
+    void insert(int program_id, int example_id, const Data& value);
+    void clear();
+    long long getHitNum() const {return hit_num;}
+    long long getMissNum() const {return miss_num;}
+    double getHitRate() const;
+};
+
+#endif //L2S_EVALUATION_CACHE_H
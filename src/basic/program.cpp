@@ -14,14 +14,14 @@ Data Program::run(GlobalInfo *inp) {
 }
 
 Data Program::run(const DataList &inp) {
-    if (global::spec_type == S_ORACLE) {
+    if (global::context->spec_type == S_ORACLE) {
         auto *param_info = new ParamInfo(inp);
         Data result = run(param_info);
         delete param_info;
         return result;
-    } else if (global::spec_type == S_PBE) {
-        global::string_info->setInp(inp);
-        Data result = run(global::string_info);
+    } else if (global::context->spec_type == S_PBE) {
+        global::context->string_info->setInp(inp);
+        Data result = run(global::context->string_info);
         return result;
     } else assert(0);
 }
@@ -9,7 +9,6 @@
 // "semantics = nullptr" represents a placeholder in a partial AST.
 class Program {
     void initFromJsonNode(Json::Value program_root);
-    Data run(GlobalInfo* inp);
 public:
     std::vector<Program*> sub_list;
     Semantics* semantics;
@@ -33,6 +32,8 @@ public:
     std::string toString();
     void print();
     Data run(const DataList& inp);
+    // Run the program with the values of parameters stored in "inp". It does not touch any global state.
+    Data run(GlobalInfo* inp);
 };
 
 
@@ -13,6 +13,7 @@ typedef std::vector<WitnessTerm> WitnessList;
 class GlobalInfo {
 public:
     virtual std::string getName() {return "GlobalInfo";}
+    virtual ~GlobalInfo() = default;
 };
 
 // For a given example, an object of "ParamInfo" contains the values of all variables.
@@ -44,6 +45,7 @@ public:
     std::string name;
     Semantics(const std::vector<Type>& _inp_type_list, Type _oup_type, std::string _name):
         inp_type_list(_inp_type_list), oup_type(_oup_type), name(_name) {}
+    virtual ~Semantics() = default;
     virtual WitnessList witnessFunction(const DataList &oup, GlobalInfo* global_info) = 0;
     virtual Data run(const DataList &inp, GlobalInfo* global_info) = 0;
 };
@@ -68,6 +70,7 @@ class ParamSemantics: public Semantics {
 public:
     ParamSemantics(int _id, Type _type): id(_id), type(_type),
         Semantics({}, _type, "Param" + std::to_string(_id)) {}
+    int getId() const {return id;}
     virtual WitnessList witnessFunction(const DataList& oup, GlobalInfo* global_info);
     virtual Data run(const DataList &inp, GlobalInfo *global_info) {
         ParamInfo* param_info = dynamic_cast<ParamInfo*>(global_info);
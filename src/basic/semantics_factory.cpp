@@ -1,11 +1,13 @@
 #include "semantics_factory.h"
 #include "config.h"
 #include "matrix_operator.h"
+#include "string_index.h"
+#include "string_relation.h"
 
 #include <unordered_set>
 
 namespace {
-    std::map<std::string, Semantics *> semantics_map = {
+    const std::map<std::string, Semantics *> semantics_map = {
             {"=", new IntEq()},
             {"str.++", new StringAdd()},
             {"str.replace", new StringReplace()},
@@ -30,15 +32,8 @@ namespace {
             {"L", new VectorConcatSemantics()}
     };
 
-    bool checkInList(const DataList& data_list, const Data& data) {
-        for (auto& data_2: data_list) {
-            if (data == data_2) return true;
-        }
-        return false;
-    }
-
     std::pair<int, int> datalistToRange(const DataList& inp) {
-        if (inp.size() == 0) return std::make_pair(global::KIntMin, global::KIntMax);
+        if (inp.size() == 0) return std::make_pair(global::context->KIntMin, global::context->KIntMax);
         if (inp.size() == 1) {
             int x = inp[0].getInt();
             return std::make_pair(x, x);
@@ -50,16 +45,21 @@ namespace {
         return std::make_pair(l, r);
     }
 
-    int getLastOccur(const std::string& s, const std::string& t, int r) {
-        auto i = s.find(t);
-        if (i == std::string::npos || i >= r) return global::KIntMin;
-        while (1) {
-            auto ne = s.find(t, i + 1);
-            if (ne == std::string::npos || ne >= r) {
-                return int(i) + 1;
-            }
-            i = ne;
-        }
+    // The index built for the task, or an empty index searching strings directly if there is none.
+    const StringIndex& getStringIndex(StringInfo* info) {
+        static const StringIndex empty_index({});
+        return info->string_index ? *(info->string_index) : empty_index;
+    }
+
+    // The relations computed when the example was added, or the relations computed now if there are none.
+    std::shared_ptr<const StringRelation> getStringRelation(StringInfo* info) {
+        if (info->string_relation) return info->string_relation;
+        return std::make_shared<const StringRelation>(info);
+    }
+
+    int getLastOccur(const StringIndex& index, const Data& s, std::string_view t, int r) {
+        int pos = index.getLastOccurrence(s, t, r);
+        return pos == -1 ? global::context->KIntMin : pos + 1;
     }
 }
 
@@ -67,7 +67,7 @@ Semantics* string2Semantics(std::string name) {
 #ifdef DEBUG
     assert(semantics_map.count(name) > 0);
 #endif
-    return semantics_map[name];
+    return semantics_map.at(name);
 }
 
 WitnessList StringAdd::witnessFunction(const DataList &oup, GlobalInfo *global_info) {
@@ -77,25 +77,19 @@ WitnessList StringAdd::witnessFunction(const DataList &oup, GlobalInfo *global_i
 #ifdef DEBUG
     assert(oup.size() == 1);
 #endif
-    std::string s = oup[0].getString();
-    int n = s.length();
+    int n = oup[0].getString().length();
     WitnessList result(n + 1);
-    std::string now;
-    for (int i = 0; i < n; ++i) {
-        result[i].push_back({Data(new StringValue(now))});
-        now += s[i];
-    }
-    result[n].push_back({Data(new StringValue(now))});
-    now = "";
-    result[n].push_back({Data(new StringValue(now))});
+    for (int i = 0; i <= n; ++i) {
+        result[i].push_back({oup[0].getSubstring(0, i)});
+    }
+    result[n].push_back({oup[0].getSubstring(n, 0)});
     for (int i = n - 1; i >= 0; --i) {
-        now = s[i] + now;
-        result[i].push_back({Data(new StringValue(now))});
+        result[i].push_back({oup[0].getSubstring(i, n - i)});
     }
     return result;
 }
 
-bool StringReplace::isSubSequence(std::string s, std::string t) {
+bool StringReplace::isSubSequence(std::string_view s, std::string_view t) {
     int now = 0;
     for (int i = 0; i < t.length() && now < s.length(); ++i) {
         if (t[i] == s[now]) {
@@ -105,7 +99,7 @@ bool StringReplace::isSubSequence(std::string s, std::string t) {
     return now == s.length();
 }
 
-bool StringReplace::valid(std::string res, std::string s, std::string t, StringInfo *info) {
+bool StringReplace::valid(const std::string& res, const std::string& s, const std::string& t, StringInfo *info) {
     bool is_contain = false;
     for (int i = 0; i < info->size(); ++i) {
         if ((*info)[i].getType() != TSTRING) continue;
@@ -115,25 +109,43 @@ bool StringReplace::valid(std::string res, std::string s, std::string t, StringI
     }
     if (!is_contain) return false;
     DataList inp;
-    inp.push_back(Data(new StringValue(res)));
-    inp.push_back(Data(new StringValue(s)));
-    inp.push_back(Data(new StringValue("")));
+    inp.push_back(Data(res));
+    inp.push_back(Data(s));
+    inp.push_back(Data(""));
     if (run(inp, info).getString() != t) return false;
     return true;
 }
 
-void StringReplace::searchForAllMaximam(int pos, std::string res, std::string s, std::string t, WitnessList &result, StringInfo *info) {
+// All maximal strings obtained by inserting copies of "s" into "res" at positions no smaller than "pos", such that
+// every intermediate string is valid. A state (pos, res) is reached through many orders of insertions, so results are
+// memoized on states and validity is memoized on strings. The results of a state are distinct and are listed in the
+// order they are first found by the depth-first search. Only the first "config::KReplaceWitnessLimit" are kept.
+const std::vector<std::string>& StringReplace::searchForAllMaximam(int pos, const std::string& res, const std::string& s,
+        const std::string& t, StringInfo *info, MaximumSearchCache& cache) {
+    auto state = std::make_pair(pos, res);
+    auto it = cache.result_map.find(state);
+    if (it != cache.result_map.end()) return it->second;
+    std::vector<std::string> result;
+    std::unordered_set<std::string> result_set;
     bool is_end = true;
     for (int i = pos; i < res.length(); ++i) {
         std::string now = res.substr(0, i) + s + res.substr(i, res.length());
-        if (valid(now, s, t, info)) {
+        auto valid_it = cache.valid_map.find(now);
+        if (valid_it == cache.valid_map.end()) {
+            valid_it = cache.valid_map.insert(std::make_pair(now, valid(now, s, t, info))).first;
+        }
+        if (valid_it->second) {
             is_end = false;
-            searchForAllMaximam(pos + s.length(), now, s, t, result, info);
+            for (auto& maximum: searchForAllMaximam(pos + s.length(), now, s, t, info, cache)) {
+                if (result.size() >= config::KReplaceWitnessLimit) break;
+                if (result_set.insert(maximum).second) result.push_back(maximum);
+            }
         }
     }
     if (is_end) {
-        result.push_back({{Data(new StringValue(res))}, {Data(new StringValue(s))}, {Data(new StringValue(""))}});
+        result.push_back(res);
     }
+    return cache.result_map[state] = std::move(result);
 }
 
 WitnessList StringReplace::witnessFunction(const DataList &oup, GlobalInfo *global_info) {
@@ -144,7 +156,6 @@ WitnessList StringReplace::witnessFunction(const DataList &oup, GlobalInfo *glob
 #ifdef DEBUG
     assert(oup.size() == 1 && string_info != nullptr);
 #endif
-    std::string oup_value = oup[0].getString();
     DataList inp;
     inp.push_back(oup[0]);
     WitnessList result;
@@ -172,7 +183,12 @@ WitnessList StringReplace::witnessFunction(const DataList &oup, GlobalInfo *glob
             if (s_data.getString().length() == 0 ||
                 oup[0].getString().find(s_data.getString()) != std::string::npos)
                 continue;
-            searchForAllMaximam(0, oup[0].getString(), s_data.getString(), oup[0].getString(), result, string_info);
+            std::string oup_value(oup[0].getString());
+            MaximumSearchCache cache;
+            for (auto& maximum: searchForAllMaximam(0, oup_value, std::string(s_data.getString()), oup_value,
+                    string_info, cache)) {
+                result.push_back({{Data(maximum)}, {s_data}, {Data("")}});
+            }
         }
     }
     return result;
@@ -180,27 +196,26 @@ WitnessList StringReplace::witnessFunction(const DataList &oup, GlobalInfo *glob
 
 WitnessList StringAt::witnessFunction(const DataList &oup, GlobalInfo *global_info) {
     if (oup.empty()) {
-        return {{{}, {Data(new IntValue(global::KIntMin)), Data(new IntValue(global::KIntMax))}}};
+        return {{{}, {Data(global::context->KIntMin), Data(global::context->KIntMax)}}};
     }
     auto* info = dynamic_cast<StringInfo*>(global_info);
 #ifdef DEBUG
     assert(oup.size() == 1 && info != nullptr);
 #endif
-    if (oup[0].getString().length() > 1) return {};
+    if (oup[0].getString().length() != 1) return {};
     // Assume the first input can only be constants or params
-    char t = oup[0].getString()[0];
+    std::string_view t = oup[0].getString();
+    auto& index = getStringIndex(info);
     WitnessList result;
     for (int i = 0; i < info->size(); ++i) {
         if ((*info)[i].getType() != TSTRING) continue;
-        std::string s = (*info)[i].getString();
-        for (int j = 0; j < s.length(); ++j) {
-            if (s[j] == t) result.push_back({{Data(new StringValue(s))}, {Data(new IntValue(j))}});
+        for (int j: index.getAllOccurrences((*info)[i], t)) {
+            result.push_back({{(*info)[i]}, {Data(j)}});
         }
     }
     for (auto& const_data: info->const_list) {
-        std::string s = const_data.getString();
-        for (int j = 0; j < s.length(); ++j) {
-            if (s[j] == t) result.push_back({{const_data}, {Data(new IntValue(j))}});
+        for (int j: index.getAllOccurrences(const_data, t)) {
+            result.push_back({{const_data}, {Data(j)}});
         }
     }
     return result;
@@ -208,61 +223,61 @@ WitnessList StringAt::witnessFunction(const DataList &oup, GlobalInfo *global_in
 
 WitnessList IntToString::witnessFunction(const DataList &oup, GlobalInfo *global_info) {
     if (oup.empty()) {
-        return {{{Data(new IntValue(global::KIntMin)), Data(new IntValue(global::KIntMax))}}};
+        return {{{Data(global::context->KIntMin), Data(global::context->KIntMax)}}};
     }
 #ifdef DEBUG
     assert(oup.size() == 1);
 #endif
-    std::string result = oup[0].getString();
+    std::string_view result = oup[0].getString();
     if (result.length() == 0 || result.length() >= 8) return {};
     if (result.length() > 0 && result[0] == '0') return {};
     for (char c: result) {
         //TODO complete it
         if (!isdigit(c)) return {};
     }
-    int int_value = std::stoi(result);
-    return {{{Data(new IntValue(int_value))}}};
+    int int_value = std::stoi(std::string(result));
+    return {{{Data(int_value)}}};
 }
 
-void StringSubstr::getAllChoice(std::string s, std::string t, WitnessList &result) {
+void StringSubstr::getAllChoice(const Data& s_data, std::string_view t, const StringIndex& index, WitnessList &result) {
+    std::string_view s = s_data.getString();
     if (t.length() > s.length()) return;
     if (t.length() == 0) {
-        result.push_back({{Data(new StringValue(s))},
-                          {Data(new IntValue(global::KIntMin)), Data(new IntValue(-1))}, {}});
-        result.push_back({{Data(new StringValue(s))}, {},
-                          {Data(new IntValue(global::KIntMin)), Data(new IntValue(0))}});
-        if (s.length() <= global::KIntMax) {
-            result.push_back({{Data(new StringValue(s))},
-                              {Data(new IntValue(s.length())), Data(new IntValue(global::KIntMax))}, {}});
+        result.push_back({{s_data},
+                          {Data(global::context->KIntMin), Data(-1)}, {}});
+        result.push_back({{s_data}, {},
+                          {Data(global::context->KIntMin), Data(0)}});
+        if (s.length() <= global::context->KIntMax) {
+            result.push_back({{s_data},
+                              {Data(int(s.length())), Data(global::context->KIntMax)}, {}});
         }
         return;
     }
     int n = s.length();
     int m = t.length();
-    for (auto i = s.find(t); i != std::string::npos; i = s.find(t, i + 1)) {
+    for (int i: index.getAllOccurrences(s_data, t)) {
         if (i != n - m) {
-            result.push_back({{Data(new StringValue(s))}, {Data(new IntValue(i))}, {Data(new IntValue(m))}});
+            result.push_back({{s_data}, {Data(i)}, {Data(m)}});
         } else {
-            result.push_back({{Data(new StringValue(s))}, {Data(new IntValue(i))}, {Data(new IntValue(m)), Data(new IntValue(global::KIntMax))}});
+            result.push_back({{s_data}, {Data(i)}, {Data(m), Data(global::context->KIntMax)}});
         }
     }
 }
 
 WitnessList StringSubstr::witnessFunction(const DataList &oup, GlobalInfo *global_info) {
     if (oup.size() == 0) {
-        return {{{}, {Data(new IntValue(global::KIntMin)), Data(new IntValue(global::KIntMax))},
-                 {Data(new IntValue(global::KIntMin)), Data(new IntValue(global::KIntMax))}}};
+        return {{{}, {Data(global::context->KIntMin), Data(global::context->KIntMax)},
+                 {Data(global::context->KIntMin), Data(global::context->KIntMax)}}};
     }
     auto* info = dynamic_cast<StringInfo*>(global_info);
 #ifdef DEBUG
     assert(oup.size() == 1 && info != nullptr);
 #endif
-    std::string oup_value = oup[0].getString();
+    std::string_view oup_value = oup[0].getString();
     WitnessList result;
     for (int i = 0; i < info->size(); ++i) {
         if ((*info)[i].getType() != TSTRING) continue;
-        std::string param_value = (*info)[i].getString();
-        getAllChoice(param_value, oup_value, result);
+        getAllChoice((*info)[i], oup_value, getStringIndex(info), result);
     }
     return result;
 }
@@ -274,11 +289,11 @@ WitnessList IntAdd::witnessFunction(const DataList &oup, GlobalInfo *global_info
     if (oup.size() == 1) {
         int oup_value = oup[0].getInt();
         WitnessList result;
-        for (int i = global::KIntMin; i <= global::KIntMax; ++i) {
+        for (int i = global::context->KIntMin; i <= global::context->KIntMax; ++i) {
             int j = oup_value - i;
-            if (j >= global::KIntMin && j <= i) {
-                result.push_back({{Data(new IntValue(i))},
-                                  {Data(new IntValue(j))}});
+            if (j >= global::context->KIntMin && j <= i) {
+                result.push_back({{Data(i)},
+                                  {Data(j)}});
             }
         }
         return result;
@@ -288,12 +303,12 @@ WitnessList IntAdd::witnessFunction(const DataList &oup, GlobalInfo *global_info
     assert(oup.size() == 2 && l <= r);
 #endif
     WitnessList result;
-    for (int i = global::KIntMin; i <= global::KIntMax; ++i) {
+    for (int i = global::context->KIntMin; i <= global::context->KIntMax; ++i) {
         int new_l = l - i, new_r = r - i;
-        new_l = std::max(new_l, global::KIntMin);
-        new_r = std::min(new_r, global::KIntMax);
+        new_l = std::max(new_l, global::context->KIntMin);
+        new_r = std::min(new_r, global::context->KIntMax);
         if (new_l <= new_r) {
-            result.push_back({{Data(new IntValue(i))}, {Data(new IntValue(new_l)), Data(new IntValue(new_r))}});
+            result.push_back({{Data(i)}, {Data(new_l), Data(new_r)}});
         }
     }
     return result;
@@ -306,11 +321,11 @@ WitnessList IntMinus::witnessFunction(const DataList &oup, GlobalInfo *global_in
     if (oup.size() == 1) {
         int oup_value = oup[0].getInt();
         WitnessList result;
-        for (int i = global::KIntMin; i <= global::KIntMax; ++i) {
+        for (int i = global::context->KIntMin; i <= global::context->KIntMax; ++i) {
             int j = i - oup_value;
-            if (j >= global::KIntMin && j <= global::KIntMax) {
-                result.push_back({{Data(new IntValue(i))},
-                                  {Data(new IntValue(j))}});
+            if (j >= global::context->KIntMin && j <= global::context->KIntMax) {
+                result.push_back({{Data(i)},
+                                  {Data(j)}});
             }
         }
         return result;
@@ -321,12 +336,12 @@ WitnessList IntMinus::witnessFunction(const DataList &oup, GlobalInfo *global_in
     assert(l <= r && oup.size() == 2);
 #endif
     WitnessList result;
-    for (int i = global::KIntMin; i <= global::KIntMax; ++i) {
+    for (int i = global::context->KIntMin; i <= global::context->KIntMax; ++i) {
         int new_l = i - r, new_r = i - l;
-        new_l = std::max(new_l, global::KIntMin);
-        new_r = std::min(new_r, global::KIntMax);
+        new_l = std::max(new_l, global::context->KIntMin);
+        new_r = std::min(new_r, global::context->KIntMax);
         if (new_l <= new_r) {
-            result.push_back({{Data(new IntValue(i))}, {Data(new IntValue(new_l)), Data(new IntValue(new_r))}});
+            result.push_back({{Data(i)}, {Data(new_l), Data(new_r)}});
         }
     }
     return result;
@@ -354,7 +369,7 @@ WitnessList StringToInt::witnessFunction(const DataList &oup, GlobalInfo *global
     l = std::max(l, 0);
     WitnessList result;
     for (int i = l; i <= r; ++i) {
-        result.push_back({{Data(new StringValue(std::to_string(i)))}});
+        result.push_back({{Data(std::to_string(i))}});
     }
     return result;
 }
@@ -369,29 +384,30 @@ WitnessList StringIndexOf::witnessFunction(const DataList &oup, GlobalInfo *glob
     int l = std::max(-1, res.first);
     int r = res.second;
     if (l > r) return {};
+    auto& index = getStringIndex(string_info);
     for (int i = 0; i < string_info->size(); ++i) {
         if ((*string_info)[i].getType() != TSTRING) continue;
-        std::string s = (*string_info)[i].getString();
+        std::string_view s = (*string_info)[i].getString();
         if (l == -1) {
-            for (auto const_str: string_info->const_set) {
-                int l = getLastOccur(s, const_str, s.length());
-                if (l <= global::KIntMin) {
-                    result.push_back({{Data(new StringValue(s))},
-                                      {Data(new StringValue(const_str))},
-                                      {Data(new IntValue(l)), Data(new IntValue(global::KIntMax))}});
+            for (const auto& const_str: string_info->const_set) {
+                int l = getLastOccur(index, (*string_info)[i], const_str, s.length());
+                if (l <= global::context->KIntMin) {
+                    result.push_back({{(*string_info)[i]},
+                                      {Data(const_str)},
+                                      {Data(l), Data(global::context->KIntMax)}});
                 }
             }
         }
         for (int pos = std::max(0, l); pos <= std::min(r, int(s.length())); ++pos) {
-            std::string now;
-            now += s[pos];
-            result.push_back({{Data(new StringValue(s))}, {Data(new StringValue(now))},
-                              {Data(new IntValue(getLastOccur(s, now, pos))), Data(new IntValue(pos))}});
+            // As with "std::string", the character right after the end is '\0'.
+            std::string now(1, pos < s.length() ? s[pos] : '\0');
+            result.push_back({{(*string_info)[i]}, {Data(now)},
+                              {Data(getLastOccur(index, (*string_info)[i], now, pos)), Data(pos)}});
             for (int j = pos + 1; j < s.length(); ++j) {
                 now += s[j];
                 if (string_info->const_set.find(now) != string_info->const_set.end()) {
-                    result.push_back({{Data(new StringValue(s))}, {Data(new StringValue(now))},
-                                      {Data(new IntValue(getLastOccur(s, now, pos))), Data(new IntValue(pos))}});
+                    result.push_back({{(*string_info)[i]}, {Data(now)},
+                                      {Data(getLastOccur(index, (*string_info)[i], now, pos)), Data(pos)}});
                 }
             }
         }
@@ -406,24 +422,14 @@ WitnessList StringPrefixOf::witnessFunction(const DataList &oup, GlobalInfo *glo
 #ifdef DEBUG
     assert(oup.size() == 1);
 #endif
-    auto* info = dynamic_cast<StringInfo*>(global_info);
-    std::vector<Data> possible_list;
-    for (auto& s: info->const_list) {
-        if (s.getType() == TSTRING) possible_list.push_back(s);
-    }
-    for (int i = 0; i < info->size(); ++i) {
-        if ((*info)[i].getType() == TSTRING) possible_list.push_back((*info)[i]);
-    }
+    auto relation = getStringRelation(dynamic_cast<StringInfo*>(global_info));
+    auto& string_list = relation->string_list;
     WitnessList result;
     bool target = oup[0].getBool();
-    for (int i = 0; i < possible_list.size(); ++i) {
-        for (int j = 0; j < possible_list.size(); ++j) {
-            std::string s = possible_list[i].getString();
-            std::string t = possible_list[j].getString();
-            if (target == (s.length() <= t.length() && t.substr(0, s.length()) == s)) {
-                result.push_back({{possible_list[i]}, {possible_list[j]}});
-            }
-        }
+    for (int i = 0; i < string_list.size(); ++i) {
+        relation->prefix.forEach(i, target, [&](int j) {
+            result.push_back({{string_list[i]}, {string_list[j]}});
+        });
     }
     return result;
 }
@@ -435,24 +441,14 @@ WitnessList StringSuffixOf::witnessFunction(const DataList &oup, GlobalInfo *glo
 #ifdef DEBUG
     assert(oup.size() == 1);
 #endif
-    auto* info = dynamic_cast<StringInfo*>(global_info);
-    std::vector<Data> possible_list;
-    for (auto& s: info->const_list) {
-        if (s.getType() == TSTRING) possible_list.push_back(s);
-    }
-    for (int i = 0; i < info->size(); ++i) {
-        if ((*info)[i].getType() == TSTRING) possible_list.push_back((*info)[i]);
-    }
+    auto relation = getStringRelation(dynamic_cast<StringInfo*>(global_info));
+    auto& string_list = relation->string_list;
     WitnessList result;
     bool target = oup[0].getBool();
-    for (int i = 0; i < possible_list.size(); ++i) {
-        for (int j = 0; j < possible_list.size(); ++j) {
-            std::string s = possible_list[i].getString();
-            std::string t = possible_list[j].getString();
-            if (target == (s.length() <= t.length() && t.substr(t.length() - s.length(), s.length()) == s)) {
-                result.push_back({{possible_list[i]}, {possible_list[j]}});
-            }
-        }
+    for (int i = 0; i < string_list.size(); ++i) {
+        relation->suffix.forEach(i, target, [&](int j) {
+            result.push_back({{string_list[i]}, {string_list[j]}});
+        });
     }
     return result;
 }
@@ -464,24 +460,14 @@ WitnessList StringContains::witnessFunction(const DataList &oup, GlobalInfo *glo
 #ifdef DEBUG
     assert(oup.size() == 1);
 #endif
-    auto* info = dynamic_cast<StringInfo*>(global_info);
-    std::vector<Data> possible_list;
-    for (auto& s: info->const_list) {
-        if (s.getType() == TSTRING) possible_list.push_back(s);
-    }
-    for (int i = 0; i < info->size(); ++i) {
-        if ((*info)[i].getType() == TSTRING) possible_list.push_back((*info)[i]);
-    }
+    auto relation = getStringRelation(dynamic_cast<StringInfo*>(global_info));
+    auto& string_list = relation->string_list;
     WitnessList result;
     bool target = oup[0].getBool();
-    for (int i = 0; i < possible_list.size(); ++i) {
-        for (int j = 0; j < possible_list.size(); ++j) {
-            std::string s = possible_list[i].getString();
-            std::string t = possible_list[j].getString();
-            if (target == (s.find(t) != std::string::npos)) {
-                result.push_back({{possible_list[i]}, {possible_list[j]}});
-            }
-        }
+    for (int i = 0; i < string_list.size(); ++i) {
+        relation->contain.forEach(i, target, [&](int j) {
+            result.push_back({{string_list[i]}, {string_list[j]}});
+        });
     }
     return result;
 }
@@ -492,25 +478,25 @@ WitnessList IntEq::witnessFunction(const DataList &oup, GlobalInfo *global_info)
     }
     WitnessList result;
     if (oup[0].getBool()) {
-        for (int i = global::KIntMin; i <= global::KIntMax; ++i) {
-            result.push_back({{Data(new IntValue(i))}, {Data(new IntValue(i))}});
+        for (int i = global::context->KIntMin; i <= global::context->KIntMax; ++i) {
+            result.push_back({{Data(i)}, {Data(i)}});
         }
     } else {
-        for (int i = global::KIntMin; i <= global::KIntMax; ++i) {
-            if (i > global::KIntMin) {
-                if (i == global::KIntMin + 1) {
-                    result.push_back({{Data(new IntValue(i))}, {Data(new IntValue(global::KIntMin))}});
+        for (int i = global::context->KIntMin; i <= global::context->KIntMax; ++i) {
+            if (i > global::context->KIntMin) {
+                if (i == global::context->KIntMin + 1) {
+                    result.push_back({{Data(i)}, {Data(global::context->KIntMin)}});
                 } else {
-                    result.push_back({{Data(new IntValue(i))},
-                                      {Data(new IntValue(global::KIntMin)), Data(new IntValue(i - 1))}});
+                    result.push_back({{Data(i)},
+                                      {Data(global::context->KIntMin), Data(i - 1)}});
                 }
             }
-            if (i < global::KIntMax) {
-                if (i == global::KIntMax - 1) {
-                    result.push_back({{Data(new IntValue(i))}, {Data(new IntValue(global::KIntMax))}});
+            if (i < global::context->KIntMax) {
+                if (i == global::context->KIntMax - 1) {
+                    result.push_back({{Data(i)}, {Data(global::context->KIntMax)}});
                 } else {
-                    result.push_back({{Data(new IntValue(i))},
-                                      {Data(new IntValue(i + 1)), Data(new IntValue(global::KIntMax))}});
+                    result.push_back({{Data(i)},
+                                      {Data(i + 1), Data(global::context->KIntMax)}});
                 }
             }
         }
@@ -520,15 +506,15 @@ WitnessList IntEq::witnessFunction(const DataList &oup, GlobalInfo *global_info)
 
 WitnessList IntIte::witnessFunction(const DataList &oup, GlobalInfo *global_info) {
     if (oup.size() == 0) {
-        return {{{Data(new BoolValue(true))}, {}, {}}, {{Data(new BoolValue(false))}, {}, {}}};
+        return {{{Data(true)}, {}, {}}, {{Data(false)}, {}, {}}};
     }
-    return {{{Data(new BoolValue(true))}, oup, {Data(new IntValue(global::KIntMin)), Data(new IntValue(global::KIntMax))}},
-            {{Data(new BoolValue(false))}, {Data(new IntValue(global::KIntMin)), Data(new IntValue(global::KIntMax))}, oup}};
+    return {{{Data(true)}, oup, {Data(global::context->KIntMin), Data(global::context->KIntMax)}},
+            {{Data(false)}, {Data(global::context->KIntMin), Data(global::context->KIntMax)}, oup}};
 }
 
 WitnessList StringIte::witnessFunction(const DataList &oup, GlobalInfo *global_info) {
     if (oup.size() == 0) {
         return {{{}, {}, {}}};
     }
-    return {{{Data(new BoolValue(true))}, oup, {}}, {{Data(new BoolValue(false))}, {}, oup}};
+    return {{{Data(true)}, oup, {}}, {{Data(false)}, {}, oup}};
 }
\ No newline at end of file
@@ -5,6 +5,7 @@
 #include "config.h"
 
 #include <map>
+#include <unordered_map>
 
 // A map translating the name of an operator into an object of "Semantics".
 // If a new operator is used, it must be registered in this function.
@@ -18,7 +19,7 @@ public:
 #ifdef DEBUG
         check(input_list);
 #endif
-        return Data(new StringValue(input_list[0].getString() + input_list[1].getString()));
+        return input_list[0].concat(input_list[1]);
     }
 
     virtual WitnessList witnessFunction(const DataList& oup, GlobalInfo* global_info);
@@ -33,10 +34,8 @@ public:
         check(input_list);
 #endif
         int pos = input_list[1].getInt();
-        std::string s = input_list[0].getString();
-        if (pos < 0 || pos >= s.length()) return Data(new StringValue(""));
-        char result[2] = {s[pos], 0};
-        return Data(new StringValue(std::string(result)));
+        if (pos < 0 || pos >= input_list[0].getString().length()) return Data("");
+        return input_list[0].getSubstring(pos, 1);
     }
 
     virtual WitnessList witnessFunction(const DataList& oup, GlobalInfo* global_info);
@@ -50,14 +49,14 @@ public:
 #ifdef DEBUG
         check(input_list);
 #endif
-        return Data(new StringValue(std::to_string(input_list[0].getInt())));
+        return Data(std::to_string(input_list[0].getInt()));
     }
 
     virtual WitnessList witnessFunction(const DataList& oup, GlobalInfo* global_info);
 };
 
 class StringSubstr: public Semantics {
-    void getAllChoice(std::string s, std::string t, WitnessList& result);
+    void getAllChoice(const Data& s_data, std::string_view t, const StringIndex& index, WitnessList& result);
 public:
     StringSubstr(): Semantics({TSTRING, TINT, TINT}, TSTRING, "str.substr") {}
 
@@ -66,18 +65,23 @@ public:
         check(input_list);
 #endif
         int pos = input_list[1].getInt();
-        std::string s = input_list[0].getString();
-        if (pos < 0 || pos >= s.length() || input_list[2].getInt() < 0) return Data(new StringValue(""));
-        return Data(new StringValue(s.substr(pos, input_list[2].getInt())));
+        if (pos < 0 || pos >= input_list[0].getString().length() || input_list[2].getInt() < 0) return Data("");
+        return input_list[0].getSubstring(pos, input_list[2].getInt());
     }
 
     virtual WitnessList witnessFunction(const DataList& oup, GlobalInfo* global_info);
 };
 
 class StringReplace: public Semantics {
-    bool isSubSequence(std::string s, std::string t);
-    bool valid(std::string res, std::string s, std::string t, StringInfo* info);
-    void searchForAllMaximam(int pos, std::string res, std::string s, std::string t, WitnessList& result, StringInfo* info);
+    // The memoization of "searchForAllMaximam" for a fixed pair of "s" and "t".
+    struct MaximumSearchCache {
+        std::unordered_map<std::string, bool> valid_map;
+        std::map<std::pair<int, std::string>, std::vector<std::string>> result_map;
+    };
+    bool isSubSequence(std::string_view s, std::string_view t);
+    bool valid(const std::string& res, const std::string& s, const std::string& t, StringInfo* info);
+    const std::vector<std::string>& searchForAllMaximam(int pos, const std::string& res, const std::string& s,
+            const std::string& t, StringInfo* info, MaximumSearchCache& cache);
 public:
     StringReplace(): Semantics({TSTRING, TSTRING, TSTRING}, TSTRING, "str.replace") {}
 
@@ -85,14 +89,14 @@ public:
 #ifdef DEBUG
         check(input_list);
 #endif
-        std::string result = input_list[0].getString();
-        std::string s = input_list[1].getString();
-        std::string t = input_list[2].getString();
-        std::vector<int> occur;
+        std::string_view s = input_list[1].getString();
+        std::string_view t = input_list[2].getString();
+        if (input_list[0].getString().find(s) == std::string::npos) return input_list[0];
+        std::string result(input_list[0].getString());
         for (auto i = result.find(s, 0); i != std::string::npos; i = result.find(s, i + t.length())) {
             result.replace(i, s.length(), t);
         }
-        return Data(new StringValue(result));
+        return Data(result);
     }
 
     virtual WitnessList witnessFunction(const DataList& oup, GlobalInfo* global_info);
@@ -106,7 +110,7 @@ public:
 #ifdef DEBUG
         check(input_list);
 #endif
-        return Data(new IntValue(input_list[0].getInt() + input_list[1].getInt()));
+        return Data(input_list[0].getInt() + input_list[1].getInt());
     }
 
     virtual WitnessList witnessFunction(const DataList& oup, GlobalInfo* global_info);
@@ -120,7 +124,7 @@ public:
 #ifdef DEBUG
         check(input_list);
 #endif
-        return Data(new IntValue(input_list[0].getInt() - input_list[1].getInt()));
+        return Data(input_list[0].getInt() - input_list[1].getInt());
     }
 
     virtual WitnessList witnessFunction(const DataList& oup, GlobalInfo* global_info);
@@ -134,7 +138,7 @@ public:
 #ifdef DEBUG
         check(input_list);
 #endif
-        return Data(new BoolValue(input_list[0].getInt() == input_list[1].getInt()));
+        return Data(input_list[0].getInt() == input_list[1].getInt());
     }
 
     virtual WitnessList witnessFunction(const DataList& oup, GlobalInfo* global_info);
@@ -148,7 +152,7 @@ public:
 #ifdef DEBUG
         check(input_list);
 #endif
-        return Data(new IntValue(input_list[0].getString().length()));
+        return Data(int(input_list[0].getString().length()));
     }
 
     virtual WitnessList witnessFunction(const DataList& oup, GlobalInfo* global_info);
@@ -163,7 +167,7 @@ public:
         check(input_list);
 #endif
         //TODO: The case when the input string is not a number.
-        return Data(new IntValue(std::atoi(input_list[0].getString().c_str())));
+        return Data(std::atoi(std::string(input_list[0].getString()).c_str()));
     }
 
     virtual WitnessList witnessFunction(const DataList& oup, GlobalInfo* global_info);
@@ -179,9 +183,9 @@ public:
 #endif
         auto result = input_list[0].getString().find(input_list[1].getString(), std::max(0, input_list[2].getInt()));
         if (result == std::string::npos) {
-            return Data(new IntValue(-1));
+            return Data(-1);
         } else {
-            return Data(new IntValue(result));
+            return Data(int(result));
         }
     }
 
@@ -196,8 +200,8 @@ public:
 #ifdef DEBUG
         check(input_list);
 #endif
-        std::string s = input_list[0].getString();
-        std::string t = input_list[1].getString();
+        std::string_view s = input_list[0].getString();
+        std::string_view t = input_list[1].getString();
         bool result = true;
         if (t.length() < s.length()) result = false;
         else {
@@ -208,7 +212,7 @@ public:
                 }
             }
         }
-        return Data(new BoolValue(result));
+        return Data(result);
     }
 
     virtual WitnessList witnessFunction(const DataList& oup, GlobalInfo* global_info);
@@ -222,8 +226,8 @@ public:
 #ifdef DEBUG
         check(input_list);
 #endif
-        std::string s = input_list[0].getString();
-        std::string t = input_list[1].getString();
+        std::string_view s = input_list[0].getString();
+        std::string_view t = input_list[1].getString();
         bool result = true;
         if (t.length() < s.length()) result = false;
         else {
@@ -234,7 +238,7 @@ public:
                 }
             }
         }
-        return Data(new BoolValue(result));
+        return Data(result);
     }
 
     virtual WitnessList witnessFunction(const DataList& oup, GlobalInfo* global_info);
@@ -248,9 +252,9 @@ public:
 #ifdef DEBUG
         check(input_list);
 #endif
-        std::string s = input_list[0].getString();
-        std::string t = input_list[1].getString();
-        return Data(new BoolValue(s.find(t) != std::string::npos));
+        std::string_view s = input_list[0].getString();
+        std::string_view t = input_list[1].getString();
+        return Data(s.find(t) != std::string::npos);
     }
 
     virtual WitnessList witnessFunction(const DataList& oup, GlobalInfo* global_info);
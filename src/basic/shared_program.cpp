@@ -0,0 +1,131 @@
+#include "shared_program.h"
+
+#include <iostream>
+
+#include "config.h"
+
+namespace {
+    size_t hashNode(int semantics_id, const std::vector<SharedProgram*>& sub_list) {
+        size_t result = 14695981039346656037ull;
+        result = (result ^ size_t(semantics_id)) * 1099511628211ull;
+        for (auto* sub_program: sub_list) {
+            result = (result ^ size_t(sub_program->id)) * 1099511628211ull;
+        }
+        return result;
+    }
+}
+
+SharedProgram::SharedProgram(int _id, size_t _hash, Semantics *_semantics, const std::vector<SharedProgram*> &_sub_list):
+    ref_num(1), id(_id), hash(_hash), semantics(_semantics), sub_list(_sub_list) {
+    for (auto* sub_program: sub_list) sub_program->addRef();
+}
+
+SharedProgram::~SharedProgram() {
+    for (auto* sub_program: sub_list) sub_program->release();
+}
+
+void SharedProgram::release() {
+    if (--ref_num == 0) delete this;
+}
+
+const std::string & SharedProgram::toString() {
+    std::call_once(name_flag, [this]() {
+        if (sub_list.empty()) {
+            name = semantics->name;
+            return;
+        }
+        name = "(" + semantics->name;
+        for (auto* sub_program: sub_list) {
+            name += " " + sub_program->toString();
+        }
+        name += ")";
+    });
+    return name;
+}
+
+void SharedProgram::print() {
+    std::cout << toString() << std::endl;
+}
+
+const CompiledProgram & SharedProgram::getCompiledProgram() {
+    std::call_once(compile_flag, [this]() {
+        compiled_program.reset(new CompiledProgram(this));
+    });
+    return *compiled_program;
+}
+
+Data SharedProgram::run(GlobalInfo *inp) {
+    return getCompiledProgram().run(inp);
+}
+
+Data SharedProgram::run(GlobalInfo *inp, int example_id, EvaluationCache *cache) {
+    return getCompiledProgram().run(inp, example_id, cache);
+}
+
+Data SharedProgram::run(const DataList &inp) {
+    if (global::context->spec_type == S_ORACLE) {
+        auto *param_info = new ParamInfo(inp);
+        Data result = run(param_info);
+        delete param_info;
+        return result;
+    } else if (global::context->spec_type == S_PBE) {
+        global::context->string_info->setInp(inp);
+        return run(global::context->string_info);
+    } else assert(0);
+}
+
+Program * SharedProgram::toProgram() const {
+    std::vector<Program*> sub_program;
+    for (auto* sub: sub_list) {
+        sub_program.push_back(sub->toProgram());
+    }
+    return new Program(sub_program, semantics);
+}
+
+size_t SharedProgramPool::NodeKeyHash::operator()(const NodeKey &key) const {
+    return hashNode(key.semantics_id, key.sub_list);
+}
+
+int SharedProgramPool::getSemanticsId(Semantics *semantics) {
+    auto it = semantics_id_map.find(semantics);
+    if (it != semantics_id_map.end()) return it->second;
+    auto name_it = name_id_map.find(semantics->name);
+    int id;
+    if (name_it != name_id_map.end()) {
+        id = name_it->second;
+    } else {
+        id = name_id_map.size();
+        name_id_map[semantics->name] = id;
+    }
+    semantics_id_map[semantics] = id;
+    return id;
+}
+
+SharedProgram * SharedProgramPool::getProgram(Semantics *semantics, const std::vector<SharedProgram *> &sub_list) {
+    std::lock_guard<std::mutex> guard(lock);
+    NodeKey key{getSemanticsId(semantics), sub_list};
+    auto it = node_map.find(key);
+    if (it != node_map.end()) return it->second;
+    // The reference created with the node belongs to the pool.
+    auto* program = new SharedProgram(next_id++, hashNode(key.semantics_id, sub_list), semantics, sub_list);
+    node_map[key] = program;
+    return program;
+}
+
+SharedProgram * SharedProgramPool::getProgram(Program *program) {
+    std::vector<SharedProgram*> sub_list;
+    for (auto* sub_program: program->sub_list) {
+        sub_list.push_back(getProgram(sub_program));
+    }
+    return getProgram(program->semantics, sub_list);
+}
+
+void SharedProgramPool::clear() {
+    std::lock_guard<std::mutex> guard(lock);
+    for (auto& node_info: node_map) {
+        node_info.second->release();
+    }
+    node_map.clear();
+    semantics_id_map.clear();
+    name_id_map.clear();
+}
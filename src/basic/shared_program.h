@@ -0,0 +1,83 @@
+#ifndef L2S_SHARED_PROGRAM_H
+#define L2S_SHARED_PROGRAM_H
+
+#include "program.h"
+#include "compiled_program.h"
+#include "evaluation_cache.h"
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+class SharedProgramPool;
+
+// An immutable node of a program DAG. Nodes are built by a "SharedProgramPool", which hash-conses them: two nodes of
+// the same pool are structurally equal iff they are the same object, so a program is copied or compared in O(1).
+// Nodes are reference-counted, and each node holds a reference to every sub-program.
+class SharedProgram {
+    std::atomic<int> ref_num;
+    std::string name;
+    std::once_flag name_flag;
+    std::unique_ptr<CompiledProgram> compiled_program;
+    std::once_flag compile_flag;
+
+    SharedProgram(int _id, size_t _hash, Semantics* _semantics, const std::vector<SharedProgram*>& _sub_list);
+    ~SharedProgram();
+    friend class SharedProgramPool;
+public:
+    const int id;
+    const size_t hash;
+    Semantics* const semantics;
+    const std::vector<SharedProgram*> sub_list;
+
+    void addRef() {++ref_num;}
+    // Drop a reference. The node is deleted together with its last reference.
+    void release();
+    // The string is built once per node and reuses the strings of sub-programs.
+    const std::string& toString();
+    void print();
+    // The program is compiled on the first call and then run as bytecode.
+    const CompiledProgram& getCompiledProgram();
+    Data run(const DataList& inp);
+    Data run(GlobalInfo* inp);
+    // Run the program on the example "example_id", whose parameters are stored in "inp". The outputs of the program
+    // and its sub-programs on this example are looked up in and recorded into "cache".
+    Data run(GlobalInfo* inp, int example_id, EvaluationCache* cache);
+    // Expand the DAG into a new (unshared) AST.
+    Program* toProgram() const;
+};
+
+// A table hash-consing "SharedProgram" nodes. Semantics are identified by their names, so programs using different
+// "Semantics" objects of the same operator are still shared. The pool holds a reference to every node it builds, and
+// nodes referenced from elsewhere survive "clear".
+class SharedProgramPool {
+    struct NodeKey {
+        int semantics_id;
+        std::vector<SharedProgram*> sub_list;
+        bool operator == (const NodeKey& key) const {
+            return semantics_id == key.semantics_id && sub_list == key.sub_list;
+        }
+    };
+    struct NodeKeyHash {
+        size_t operator () (const NodeKey& key) const;
+    };
+    std::mutex lock;
+    std::unordered_map<Semantics*, int> semantics_id_map;
+    std::unordered_map<std::string, int> name_id_map;
+    std::unordered_map<NodeKey, SharedProgram*, NodeKeyHash> node_map;
+    // Ids are never reused, so that nodes surviving "clear" keep unique ids.
+    int next_id;
+
+    int getSemanticsId(Semantics* semantics);
+public:
+    // Return the node of "semantics" applied to "sub_list", which are nodes of this pool. Thread-safe.
+    SharedProgram* getProgram(Semantics* semantics, const std::vector<SharedProgram*>& sub_list);
+    SharedProgram* getProgram(Program* program);
+    SharedProgramPool(): next_id(0) {}
+    int size() const {return node_map.size();}
+    void clear();
+    ~SharedProgramPool() {clear();}
+};
+
+#endif //L2S_SHARED_PROGRAM_H
@@ -3,8 +3,10 @@
 #include "util.h"
 #include "config.h"
 
+#include <atomic>
 #include <fstream>
 #include <sstream>
+#include <unordered_map>
 #include <iostream>
 
 using util::string2Type;
@@ -74,37 +76,127 @@ Specification::Specification(std::string file_name) {
         }
     }
     recognizeSpecType();
-    if (global::spec_type == S_PBE) {
+    if (global::context->spec_type == S_PBE) {
         initGlobalInfoForPBE();
     }
     assert(start_terminal != nullptr);
 }
 
-bool Specification::verify(Program *program, Example*& counter_example) {
-    assert(global::spec_type == S_PBE);
-    if (global::spec_type == S_PBE) {
-        for (auto* example: example_space) {
-            if (program->run(example->inp) != example->oup) {
-                counter_example = new Example(example->inp, example->oup);
-                return false;
+namespace {
+    // The number of groups of examples verified by a single task.
+    const int verify_chunk_size = 64;
+
+    struct DataListHash {
+        size_t operator () (const DataList& data_list) const {
+            size_t result = data_list.size();
+            for (auto& data: data_list) result = result * 1000003 + data.hash();
+            return result;
+        }
+    };
+}
+
+void Specification::buildInputGroups() {
+    std::lock_guard<std::mutex> guard(group_lock);
+    if (grouped_example_num == example_space.size()) return;
+    input_group_list.clear();
+    std::unordered_map<DataList, int, DataListHash> group_id_map;
+    for (int i = 0; i < example_space.size(); ++i) {
+        auto it = group_id_map.find(example_space[i]->inp);
+        if (it == group_id_map.end()) {
+            group_id_map.insert(std::make_pair(example_space[i]->inp, int(input_group_list.size())));
+            input_group_list.push_back({i});
+        } else {
+            input_group_list[it->second].push_back(i);
+        }
+    }
+    grouped_example_num = example_space.size();
+}
+
+bool Specification::verify(const std::function<Data(GlobalInfo*, int)>& run,
+        std::vector<Example*>& counter_example_list, bool is_find_all) {
+    assert(global::context->spec_type == S_PBE);
+    buildInputGroups();
+    int group_num = input_group_list.size();
+    int chunk_num = (group_num + verify_chunk_size - 1) / verify_chunk_size;
+    // The failing examples of each chunk. Without "is_find_all", chunks after the first failing chunk are skipped,
+    // so that the result is the same as that of a sequential scan.
+    std::vector<std::vector<int>> failed_list(chunk_num);
+    std::atomic<int> first_failed_chunk(chunk_num);
+    auto verify_chunk = [&](int chunk_id) {
+        int l = chunk_id * verify_chunk_size, r = std::min(group_num, l + verify_chunk_size);
+        for (int group_id = l; group_id < r; ++group_id) {
+            if (!is_find_all && first_failed_chunk < chunk_id) return;
+            auto& group = input_group_list[group_id];
+            ::ParamInfo info(example_space[group[0]]->inp);
+            Data oup = run(&info, group[0]);
+            for (int example_id: group) {
+                if (oup != example_space[example_id]->oup) failed_list[chunk_id].push_back(example_id);
+            }
+            if (!is_find_all && !failed_list[chunk_id].empty()) {
+                int current = first_failed_chunk;
+                while (chunk_id < current && !first_failed_chunk.compare_exchange_weak(current, chunk_id));
+                return;
             }
         }
+    };
+    if (global::thread_pool) {
+        global::thread_pool->parallelFor(chunk_num, verify_chunk);
+    } else {
+        for (int i = 0; i < chunk_num && first_failed_chunk == chunk_num; ++i) verify_chunk(i);
+    }
+    for (auto& failed_example_list: failed_list) {
+        for (int example_id: failed_example_list) {
+            auto* example = example_space[example_id];
+            counter_example_list.push_back(new Example(example->inp, example->oup));
+            if (!is_find_all) return false;
+        }
+    }
+    return counter_example_list.empty();
+}
+
+bool Specification::verify(Program *program, Example*& counter_example) {
+    return verify(CompiledProgram(program), counter_example);
+}
+
+bool Specification::verify(SharedProgram *program, Example *&counter_example, EvaluationCache *cache) {
+    std::vector<Example*> counter_example_list;
+    if (verify(program, counter_example_list, false, cache)) return true;
+    counter_example = counter_example_list[0];
+    return false;
+}
+
+bool Specification::verify(const CompiledProgram &program, Example *&counter_example) {
+    std::vector<Example*> counter_example_list;
+    if (verify([&program](GlobalInfo* inp, int example_id) {return program.run(inp);}, counter_example_list, false)) {
         return true;
     }
+    counter_example = counter_example_list[0];
+    return false;
+}
+
+bool Specification::verify(SharedProgram *program, std::vector<Example *> &counter_example_list, bool is_find_all,
+        EvaluationCache *cache) {
+    if (cache == nullptr) {
+        auto& compiled_program = program->getCompiledProgram();
+        return verify([&compiled_program](GlobalInfo* inp, int example_id) {return compiled_program.run(inp);},
+                counter_example_list, is_find_all);
+    }
+    return verify([program, cache](GlobalInfo* inp, int example_id) {return program->run(inp, example_id, cache);},
+            counter_example_list, is_find_all);
 }
 
 void Specification::recognizeSpecType() {
     if (checkOracle()) {
-        global::spec_type = S_ORACLE;
+        global::context->spec_type = S_ORACLE;
     } else if (checkPBE()) {
-        global::spec_type = S_PBE;
+        global::context->spec_type = S_PBE;
     } else assert(false);
 }
 
 void Specification::initGlobalInfoForPBE() {
-    global::string_info->clear();
-    global::string_info->example_space = example_space;
-    global::string_info->spec = this;
+    global::context->string_info->clear();
+    global::context->string_info->example_space = example_space;
+    global::context->string_info->spec = this;
     for (const auto& symbol_pair: non_terminal_map) {
         auto& symbol = symbol_pair.second;
         for (auto* rule: symbol->rule_list) {
@@ -112,11 +204,11 @@ void Specification::initGlobalInfoForPBE() {
             if (const_semantics != nullptr) {
                 switch (const_semantics->value.getType()) {
                     case TINT:
-                        global::string_info->const_list.push_back(
-                                Data(new StringValue(std::to_string(const_semantics->value.getInt()))));
+                        global::context->string_info->const_list.push_back(
+                                Data(std::to_string(const_semantics->value.getInt())));
                         break;
                     case TSTRING:
-                        global::string_info->const_list.push_back(const_semantics->value);
+                        global::context->string_info->const_list.push_back(const_semantics->value);
                         break;
                     default:
                         break;
@@ -124,21 +216,43 @@ void Specification::initGlobalInfoForPBE() {
             }
         }
     }
-    global::KIntMax = 0;
-    for (auto s: global::string_info->const_list) {
-        global::KIntMax = std::max(global::KIntMax, int(s.getString().length()));
+    global::context->KIntMax = 0;
+    for (auto s: global::context->string_info->const_list) {
+        global::context->KIntMax = std::max(global::context->KIntMax, int(s.getString().length()));
     }
-    for (auto* example: global::string_info->example_space) {
+    for (auto* example: global::context->string_info->example_space) {
         for (auto& data: example->inp) {
             if (data.getType() == TSTRING) {
-                global::KIntMax = std::max(global::KIntMax, int(data.getString().length()));
+                global::context->KIntMax = std::max(global::context->KIntMax, int(data.getString().length()));
             }
         }
         if (example->oup.getType() == TSTRING) {
-            global::KIntMax = std::max(global::KIntMax, int(example->oup.getString().length()));
+            global::context->KIntMax = std::max(global::context->KIntMax, int(example->oup.getString().length()));
+        }
+    }
+    // std::cout << "ConstList" << util::dataList2String(global::context->string_info->const_list) << std::endl;
+}
+
+Specification::~Specification() {
+    for (auto& symbol_pair: non_terminal_map) {
+        for (auto* rule: symbol_pair.second->rule_list) {
+            // Parameters and constants are created for each rule, while the other semantics are shared by all rules
+            // (see "string2Semantics").
+            if (dynamic_cast<ParamSemantics*>(rule->semantics) || dynamic_cast<ConstSemantics*>(rule->semantics)) {
+                delete rule->semantics;
+            }
+            delete rule;
         }
+        delete symbol_pair.second;
     }
-    // std::cout << "ConstList" << util::dataList2String(global::string_info->const_list) << std::endl;
+    for (auto* example: example_space) delete example;
+    delete oracle;
+}
+
+void Specification::initPBE() {
+    assert(start_terminal != nullptr);
+    global::context->spec_type = S_PBE;
+    initGlobalInfoForPBE();
 }
 
 bool Specification::checkPBE() {
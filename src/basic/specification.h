@@ -3,9 +3,13 @@
 
 #include "semantics.h"
 #include "program.h"
+#include "shared_program.h"
+#include "compiled_program.h"
 #include "json/json.h"
 
+#include <functional>
 #include <map>
+#include <mutex>
 
 class Specification;
 class Rule;
@@ -35,6 +39,15 @@ public:
 // Example space "example_space" represents the semantics constraint for S_PBE. A program is valid if and only
 // if it is consistent with all examples in "example_space".
 class Specification {
+    // Indices of examples in "example_space" grouped by their inputs, in the order of their first occurrences. A
+    // candidate is run only once on each group. It is rebuilt whenever "example_space" grows.
+    std::vector<std::vector<int>> input_group_list;
+    int grouped_example_num = 0;
+    // Guards "input_group_list", since a specification may be verified by several tasks at the same time.
+    std::mutex group_lock;
+
+    void buildInputGroups();
+    bool verify(const std::function<Data(GlobalInfo*, int)>& run, std::vector<Example*>& counter_example_list, bool is_find_all);
     void recognizeSpecType();
     void initGlobalInfoForPBE();
     bool checkOracle(); // Only valid for S_ORACLE
@@ -50,14 +63,27 @@ public:
     std::vector<ParamInfo> param_list;
     Type return_type;
     std::map<std::string, NonTerminal*> non_terminal_map;
-    Program* oracle;
+    Program* oracle = nullptr;
     NonTerminal* start_terminal;
     std::map<std::string, Type> global_variable_map;
     std::vector<Example*> example_space;
     Specification() {};
     Specification(std::string file_name);
+    // Free the grammar, the examples and the oracle.
+    ~Specification();
+    // Finish a PBE specification whose grammar and examples are built directly by a parser, instead of being loaded
+    // from a json file.
+    void initPBE();
     void print();
     bool verify(Program* program, Example*& counter_example);
+    // If "cache" is given, the outputs of the program and its sub-programs are memoized in it, with the indices in
+    // "example_space" as the ids of examples.
+    bool verify(SharedProgram* program, Example*& counter_example, EvaluationCache* cache = nullptr);
+    bool verify(const CompiledProgram& program, Example*& counter_example);
+    // Verify the program on all examples, on "global::thread_pool" if it exists. The first failing example (or every
+    // failing example if "is_find_all" is set) is copied into "counter_example_list". Without "is_find_all", the
+    // remaining work is cancelled once a failing example is found.
+    bool verify(SharedProgram* program, std::vector<Example*>& counter_example_list, bool is_find_all, EvaluationCache* cache = nullptr);
 };
 
 // A grammar rule in a DSL.
@@ -0,0 +1,93 @@
+#include "string_index.h"
+
+#include <algorithm>
+
+StringIndex::SuffixArray::SuffixArray(std::string_view _text): text(_text), suffix_list(_text.length()) {
+    // Prefix doubling: sort suffixes by their first "2 * len" characters using the ranks of the first "len" ones.
+    int n = text.length();
+    std::vector<int> rank(n), new_rank(n);
+    for (int i = 0; i < n; ++i) {
+        suffix_list[i] = i;
+        rank[i] = (unsigned char)(text[i]);
+    }
+    for (int len = 1; n > 1; len <<= 1) {
+        auto cmp = [&](int x, int y) {
+            if (rank[x] != rank[y]) return rank[x] < rank[y];
+            int rank_x = x + len < n ? rank[x + len] : -1;
+            int rank_y = y + len < n ? rank[y + len] : -1;
+            return rank_x < rank_y;
+        };
+        std::sort(suffix_list.begin(), suffix_list.end(), cmp);
+        new_rank[suffix_list[0]] = 0;
+        for (int i = 1; i < n; ++i) {
+            new_rank[suffix_list[i]] = new_rank[suffix_list[i - 1]] + cmp(suffix_list[i - 1], suffix_list[i]);
+        }
+        rank.swap(new_rank);
+        if (rank[suffix_list[n - 1]] == n - 1) break;
+    }
+}
+
+std::pair<int, int> StringIndex::SuffixArray::getRange(std::string_view pattern) const {
+    auto prefix = [&](int pos) {return text.substr(pos, pattern.length());};
+    auto l = std::lower_bound(suffix_list.begin(), suffix_list.end(), pattern,
+            [&](int pos, std::string_view t) {return prefix(pos) < t;});
+    auto r = std::upper_bound(l, suffix_list.end(), pattern,
+            [&](std::string_view t, int pos) {return t < prefix(pos);});
+    return std::make_pair(int(l - suffix_list.begin()), int(r - suffix_list.begin()));
+}
+
+StringIndex::StringIndex(const DataList &string_list) {
+    for (auto& s: string_list) {
+        if (s.getType() != TSTRING || index_map.find(s) != index_map.end()) continue;
+        index_map.insert(std::make_pair(s, SuffixArray(s.getString())));
+    }
+}
+
+const StringIndex::SuffixArray * StringIndex::getSuffixArray(const Data &s) const {
+    auto it = index_map.find(s);
+    if (it == index_map.end()) return nullptr;
+    return &(it->second);
+}
+
+std::vector<int> StringIndex::getAllOccurrences(const Data &s, std::string_view t) const {
+    std::string_view text = s.getString();
+    std::vector<int> result;
+    auto* suffix_array = getSuffixArray(s);
+    // As with "std::string_view::find", the empty string occurs at every position including the end.
+    if (suffix_array == nullptr || t.empty()) {
+        for (auto i = text.find(t); i != std::string_view::npos; i = text.find(t, i + 1)) {
+            result.push_back(int(i));
+        }
+        return result;
+    }
+    auto range = suffix_array->getRange(t);
+    for (int i = range.first; i < range.second; ++i) {
+        result.push_back(suffix_array->suffix_list[i]);
+    }
+    std::sort(result.begin(), result.end());
+    return result;
+}
+
+int StringIndex::getLastOccurrence(const Data &s, std::string_view t, int r) const {
+    auto* suffix_array = getSuffixArray(s);
+    if (suffix_array == nullptr || t.empty()) {
+        if (r <= 0) return -1;
+        std::string_view text = s.getString();
+        auto i = text.rfind(t, r - 1);
+        return i == std::string_view::npos ? -1 : int(i);
+    }
+    auto range = suffix_array->getRange(t);
+    int result = -1;
+    for (int i = range.first; i < range.second; ++i) {
+        int pos = suffix_array->suffix_list[i];
+        if (pos < r) result = std::max(result, pos);
+    }
+    return result;
+}
+
+bool StringIndex::contains(const Data &s, std::string_view t) const {
+    auto* suffix_array = getSuffixArray(s);
+    if (suffix_array == nullptr || t.empty()) return s.getString().find(t) != std::string_view::npos;
+    auto range = suffix_array->getRange(t);
+    return range.first < range.second;
+}
@@ -0,0 +1,38 @@
+#ifndef L2S_STRING_INDEX_H
+#define L2S_STRING_INDEX_H
+
+#include "data.h"
+
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+// A substring index over all strings of a task (inputs and outputs of examples, and string constants).
+// A suffix array is built for every distinct string, so that the occurrences of a pattern are found by two binary
+// searches, in time depending on the length of the pattern and the number of occurrences instead of the length of
+// the string. Strings that are not indexed are searched with "std::string_view::find", with the same results.
+class StringIndex {
+    struct DataHash {
+        size_t operator () (const Data& data) const {return data.hash();}
+    };
+    struct SuffixArray {
+        std::string_view text;
+        std::vector<int> suffix_list;
+        SuffixArray(std::string_view _text);
+        // The range of suffixes starting with "pattern".
+        std::pair<int, int> getRange(std::string_view pattern) const;
+    };
+    // Keys keep the texts of the indexed strings alive.
+    std::unordered_map<Data, SuffixArray, DataHash> index_map;
+    const SuffixArray* getSuffixArray(const Data& s) const;
+public:
+    StringIndex(const DataList& string_list);
+    // All positions where "t" occurs in "s", in the increasing order.
+    std::vector<int> getAllOccurrences(const Data& s, std::string_view t) const;
+    // The last position before "r" where "t" occurs in "s", or -1 if there is no such position.
+    int getLastOccurrence(const Data& s, std::string_view t, int r) const;
+    bool contains(const Data& s, std::string_view t) const;
+    int size() const {return index_map.size();}
+};
+
+#endif //L2S_STRING_INDEX_H
@@ -0,0 +1,32 @@
+#include "string_relation.h"
+#include "config.h"
+#include "string_index.h"
+
+namespace {
+    DataList getStringList(StringInfo* info) {
+        DataList result;
+        for (auto& s: info->const_list) {
+            if (s.getType() == TSTRING) result.push_back(s);
+        }
+        for (int i = 0; i < info->size(); ++i) {
+            if ((*info)[i].getType() == TSTRING) result.push_back((*info)[i]);
+        }
+        return result;
+    }
+}
+
+StringRelation::StringRelation(StringInfo *info): string_list(getStringList(info)), contain(string_list.size()),
+    prefix(string_list.size()), suffix(string_list.size()) {
+    int n = string_list.size();
+    for (int i = 0; i < n; ++i) {
+        std::string_view s = string_list[i].getString();
+        for (int j = 0; j < n; ++j) {
+            std::string_view t = string_list[j].getString();
+            bool is_contain = info->string_index ? info->string_index->contains(string_list[i], t) :
+                    s.find(t) != std::string::npos;
+            if (is_contain) contain.set(i, j);
+            if (s.length() <= t.length() && t.compare(0, s.length(), s) == 0) prefix.set(i, j);
+            if (s.length() <= t.length() && t.compare(t.length() - s.length(), s.length(), s) == 0) suffix.set(i, j);
+        }
+    }
+}
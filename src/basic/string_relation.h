@@ -0,0 +1,45 @@
+#ifndef L2S_STRING_RELATION_H
+#define L2S_STRING_RELATION_H
+
+#include "data.h"
+
+#include <cstdint>
+
+class StringInfo;
+
+// A square matrix of bits, where each row is stored as a sequence of 64-bit words.
+class BitMatrix {
+    int n, word_num;
+    std::vector<uint64_t> word_list;
+public:
+    BitMatrix(int _n): n(_n), word_num((_n + 63) / 64), word_list(size_t(_n) * word_num, 0) {}
+    void set(int i, int j) {word_list[size_t(i) * word_num + j / 64] |= uint64_t(1) << (j & 63);}
+    bool get(int i, int j) const {return word_list[size_t(i) * word_num + j / 64] >> (j & 63) & 1;}
+    // Visit all columns j in the increasing order such that the bit (i, j) equals "value".
+    template<class F>
+    void forEach(int i, bool value, F f) const {
+        for (int w = 0; w < word_num; ++w) {
+            uint64_t word = word_list[size_t(i) * word_num + w];
+            if (!value) word = ~word;
+            if (w == word_num - 1 && (n & 63)) word &= (uint64_t(1) << (n & 63)) - 1;
+            while (word) {
+                f(w * 64 + __builtin_ctzll(word));
+                word &= word - 1;
+            }
+        }
+    }
+};
+
+// The pairwise relations among the strings available on an example: all string constants followed by all string
+// inputs. They are computed once when the example is added, so that witnesses of "str.contains", "str.prefixof" and
+// "str.suffixof" only scan rows of bits.
+class StringRelation {
+public:
+    DataList string_list;
+    // "contain(i, j)": string i contains string j.
+    // "prefix(i, j)" and "suffix(i, j)": string i is a prefix (suffix) of string j.
+    BitMatrix contain, prefix, suffix;
+    StringRelation(StringInfo* info);
+};
+
+#endif //L2S_STRING_RELATION_H
@@ -0,0 +1,120 @@
+#include "thread_pool.h"
+#include "config.h"
+
+#include <algorithm>
+
+namespace {
+    // The pool and the index of the worker running on the current thread.
+    thread_local ThreadPool* current_pool = nullptr;
+    thread_local int current_worker = -1;
+
+    // The state of one call of "parallelFor". It is shared with the helper tasks, which may start running only
+    // after the call has returned. Iterations run in the solver context of the caller.
+    struct LoopState {
+        std::function<void(int)> body;
+        int n;
+        SolverContext* context;
+        std::atomic<int> next, finished;
+        std::mutex lock;
+        std::condition_variable cond;
+        LoopState(const std::function<void(int)>& _body, int _n): body(_body), n(_n), context(global::context),
+            next(0), finished(0) {}
+        void run() {
+            SolverContextGuard guard(context);
+            int done = 0;
+            for (int i = next++; i < n; i = next++) {
+                body(i);
+                ++done;
+            }
+            if (done > 0 && (finished += done) == n) {
+                std::lock_guard<std::mutex> guard(lock);
+                cond.notify_all();
+            }
+        }
+    };
+}
+
+ThreadPool::ThreadPool(int thread_num): pending_num(0), next_queue(0), is_stopped(false) {
+    for (int i = 1; i < thread_num; ++i) {
+        queue_list.emplace_back(new TaskQueue());
+    }
+    for (int i = 1; i < thread_num; ++i) {
+        worker_list.emplace_back([this, i]() {work(i - 1);});
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        is_stopped = true;
+    }
+    cond.notify_all();
+    for (auto& worker: worker_list) worker.join();
+}
+
+bool ThreadPool::popTask(int worker_id, std::function<void()> &task) {
+    {
+        auto& own_queue = *queue_list[worker_id];
+        std::lock_guard<std::mutex> guard(own_queue.lock);
+        if (!own_queue.task_list.empty()) {
+            task = std::move(own_queue.task_list.back());
+            own_queue.task_list.pop_back();
+            --pending_num;
+            return true;
+        }
+    }
+    for (int i = 1; i < queue_list.size(); ++i) {
+        auto& victim = *queue_list[(worker_id + i) % queue_list.size()];
+        std::lock_guard<std::mutex> guard(victim.lock);
+        if (!victim.task_list.empty()) {
+            task = std::move(victim.task_list.front());
+            victim.task_list.pop_front();
+            --pending_num;
+            return true;
+        }
+    }
+    return false;
+}
+
+void ThreadPool::work(int worker_id) {
+    current_pool = this;
+    current_worker = worker_id;
+    while (true) {
+        std::function<void()> task;
+        if (popTask(worker_id, task)) {
+            task();
+            continue;
+        }
+        std::unique_lock<std::mutex> guard(lock);
+        cond.wait(guard, [this]() {return is_stopped || pending_num > 0;});
+        if (is_stopped && pending_num == 0) return;
+    }
+}
+
+void ThreadPool::submit(const std::function<void()>& task) {
+    int queue_id = current_pool == this ? current_worker : (next_queue++) % int(queue_list.size());
+    {
+        auto& queue = *queue_list[queue_id];
+        std::lock_guard<std::mutex> guard(queue.lock);
+        queue.task_list.push_back(task);
+        ++pending_num;
+    }
+    std::lock_guard<std::mutex> guard(lock);
+    cond.notify_one();
+}
+
+void ThreadPool::parallelFor(int n, const std::function<void(int)>& body) {
+    if (n <= 0) return;
+    if (worker_list.empty() || n == 1) {
+        for (int i = 0; i < n; ++i) body(i);
+        return;
+    }
+    auto state = std::make_shared<LoopState>(body, n);
+    int helper_num = std::min(int(worker_list.size()), n - 1);
+    for (int i = 0; i < helper_num; ++i) {
+        submit([state]() {state->run();});
+    }
+    state->run();
+    std::unique_lock<std::mutex> guard(state->lock);
+    state->cond.wait(guard, [&state]() {return state->finished == state->n;});
+}
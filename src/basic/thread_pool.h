@@ -0,0 +1,41 @@
+#ifndef L2S_THREAD_POOL_H
+#define L2S_THREAD_POOL_H
+
+#include <vector>
+#include <deque>
+#include <memory>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+
+// A fixed-size pool of worker threads with work stealing.
+// Each worker owns a deque of tasks: tasks submitted by a worker are pushed into its own deque and are popped in
+// LIFO order, while idle workers steal tasks from the other end of the deques of other workers.
+// "parallelFor" runs a loop body on all workers together with the calling thread and returns after every
+// iteration is finished. Since the caller also executes iterations, "parallelFor" can be nested safely.
+class ThreadPool {
+    struct TaskQueue {
+        std::mutex lock;
+        std::deque<std::function<void()>> task_list;
+    };
+    std::vector<std::thread> worker_list;
+    std::vector<std::unique_ptr<TaskQueue>> queue_list;
+    std::atomic<int> pending_num, next_queue;
+    std::mutex lock;
+    std::condition_variable cond;
+    bool is_stopped;
+
+    bool popTask(int worker_id, std::function<void()>& task);
+    void work(int worker_id);
+public:
+    ThreadPool(int thread_num);
+    ~ThreadPool();
+    // The number of threads executing tasks, including the caller of "parallelFor".
+    int size() const {return worker_list.size() + 1;}
+    void submit(const std::function<void()>& task);
+    void parallelFor(int n, const std::function<void(int)>& body);
+};
+
+#endif //L2S_THREAD_POOL_H
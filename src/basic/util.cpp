@@ -2,6 +2,7 @@
 #include <fstream>
 #include <sstream>
 #include "config.h"
+#include "constant_classifier.h"
 
 std::string util::loadStringFromFile(std::string file_name) {
     std::ifstream inp(file_name, std::ios::out);
@@ -23,11 +24,11 @@ Data util::parseDataFromJson(Json::Value node) {
     auto value_type = string2Type(node["value_type"].asString());
     switch (value_type) {
         case TINT:
-            return Data(new IntValue(node["value"].asInt()));
+            return Data(node["value"].asInt());
         case TBOOL:
-            return Data(new BoolValue(node["value"].asString() == "True" || node["value"].asString() == "true"));
+            return Data(node["value"].asString() == "True" || node["value"].asString() == "true");
         case TSTRING:
-            return Data(new StringValue(node["value"].asString()));
+            return Data(node["value"].asString());
     }
 }
 
@@ -59,12 +60,16 @@ std::string util::type2String(Type type) {
     }
 }
 
-std::string util::getStringConstType(std::string value) {
-    if (global::string_info->const_cache.count(value)) return global::string_info->const_cache[value];
+std::string util::getStringConstType(const Data& data) {
+    if (global::context->string_info->const_classifier) {
+        auto* type = global::context->string_info->const_classifier->getType(data);
+        if (type != nullptr) return *type;
+    }
+    std::string value(data.getString());
+    if (global::context->string_info->const_cache.count(value)) return global::context->string_info->const_cache[value];
     int inp_num = 0;
     int oup_num = 0;
-    int total = global::string_info->example_space.size();
-    for (auto* example: global::string_info->example_space) {
+    for (auto* example: global::context->string_info->example_space) {
         for (auto& param: example->inp) {
             if (param.getType() == TSTRING && param.getString().find(value) != std::string::npos) {
                 ++inp_num;
@@ -75,16 +80,7 @@ std::string util::getStringConstType(std::string value) {
             ++oup_num;
         }
     }
-    std::string result;
-    /*if (inp_num == total && oup_num == total) result = "AllInOutput";
-    else if (inp_num == total) result = "AllInput";
-    else if (oup_num == total) result = "AllOutput";
-    else*/ if (inp_num > 0 && oup_num > 0) result = "SomeInOutput";
-    else if (inp_num > 0) result = "SomeInput";
-    else if (oup_num > 0) result = "SomeOutput";
-    else result = "None";
-    result = "Constant@" + result;
-    return global::string_info->const_cache[value] = result;
+    return global::context->string_info->const_cache[value] = ConstantClassifier::getTypeName(inp_num, oup_num);
 }
 
 bool util::checkInOupList(const Data &value, const DataList &oup) {
@@ -11,7 +11,7 @@ namespace util {
     Json::Value loadJsonFromFile(std::string file_name);
     std::string dataList2String(const DataList& data_list);
     std::string type2String(Type type);
-    std::string getStringConstType(std::string s);
+    std::string getStringConstType(const Data& value);
     bool checkInOupList(const Data& value, const DataList& oup);
 }
 
@@ -1,75 +1,155 @@
 #ifndef L2S_VALUE_H
 #define L2S_VALUE_H
 
+#include <cassert>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
 enum Type {
     TINT, TBOOL, TSTRING, TMATRIX
 };
 
-class Value {
-    Type type;
-public:
-    Type getType() const {return type;}
-    Value(Type _type): type(_type) {}
-    virtual Value* copy() const = 0;
-    virtual ~Value() = default;
+// An immutable text referred to by string values. A string value is a span of a text, so substrings share the text of
+// the string they are taken from. Prefix hashes allow the hash of any span to be computed without scanning it.
+struct Text {
+    static const uint64_t KHashBase = 1000003;
+    std::string value;
+    // "prefix_hash[i]" is the hash of the first "i" characters.
+    std::vector<uint64_t> prefix_hash;
+    Text(std::string _value): value(std::move(_value)), prefix_hash(value.size() + 1, 0) {
+        for (int i = 0; i < value.size(); ++i) {
+            prefix_hash[i + 1] = prefix_hash[i] * KHashBase + (unsigned char)(value[i]);
+        }
+    }
+    // The hash of "value.substr(offset, length)". Equal strings have equal hashes, even in different texts.
+    uint64_t getHash(int offset, int length) const {
+        uint64_t power = 1, base = KHashBase;
+        for (int rem = length; rem; rem >>= 1, base *= base) {
+            if (rem & 1) power *= base;
+        }
+        return prefix_hash[offset + length] - prefix_hash[offset] * power;
+    }
 };
 
-class IntValue: public Value {
-    int value;
-public:
-    IntValue(int _value): Value(TINT), value(_value) {}
-    virtual Value* copy() const {return new IntValue(value);}
-    int getValue() const {return value;}
-    virtual ~IntValue() = default;
-};
+// A matrix stored as a strided view of a shared buffer: the element at index (i_0, ..., i_k) is
+// "buffer[offset + i_0 * strides[0] + ... + i_k * strides[k]]". Reshaping a contiguous matrix, permuting dimensions
+// and flipping a dimension only change the view, and contents are materialized only when they are read.
+class Matrix {
+    std::shared_ptr<const std::vector<int>> buffer;
+    std::vector<int> strides;
+    int offset;
 
-class BoolValue: public Value {
-    bool value;
+    static std::vector<int> getRowMajorStrides(const std::vector<int>& shape) {
+        std::vector<int> strides(shape.size());
+        int stride = 1;
+        for (int i = int(shape.size()) - 1; i >= 0; --i) {
+            strides[i] = stride;
+            stride *= shape[i];
+        }
+        return strides;
+    }
 public:
-    BoolValue(bool _value): Value(TBOOL), value(_value) {}
-    virtual Value* copy() const {return new BoolValue(value);}
-    bool getValue() const {return value;}
-    virtual ~BoolValue() = default;
-};
+    std::vector<int> shape;
 
-class StringValue: public Value {
-    std::string value;
-public:
-    StringValue(std::string _value): Value(TSTRING), value(_value) {}
-    virtual Value* copy() const {return new StringValue(value);}
-    std::string getValue() const {return value;}
-    virtual ~StringValue() = default;
-};
+    Matrix(std::vector<int> _contents, std::vector<int> _shape):
+        buffer(std::make_shared<const std::vector<int>>(std::move(_contents))), offset(0), shape(std::move(_shape)) {
+        strides = getRowMajorStrides(shape);
+#ifdef DEBUG
+        assert(size() == buffer->size());
+#endif
+    }
 
-struct Matrix {
-    std::vector<int> contents;
-    std::vector<int> shape;
-    Matrix(const std::vector<int>& _contents, const std::vector<int>& _shape): contents(_contents), shape(_shape) {}
-    bool operator == (const Matrix& matrix) const {
-        return shape == matrix.shape && contents == matrix.contents;
+    int size() const {
+        int result = 1;
+        for (int dim_size: shape) result *= dim_size;
+        return result;
     }
-};
 
-class MatrixValue: public Value {
-public:
-    std::vector<int> contents;
-    std::vector<int> shape;
-    MatrixValue(const std::vector<int>& _contents, const std::vector<int>& _shape): Value(TMATRIX), contents(_contents), shape(_shape) {
-#ifdef DEBUG
-        int size = 1;
+    // Visit all elements in the row-major order.
+    template<class F>
+    void forEach(F f) const {
+        int dim_num = shape.size();
         for (int dim_size: shape) {
-            size *= dim_size;
+            if (dim_size == 0) return;
+        }
+        std::vector<int> index(dim_num, 0);
+        auto& contents = *buffer;
+        int pos = offset;
+        while (true) {
+            f(contents[pos]);
+            int dim = dim_num - 1;
+            for (; dim >= 0 && index[dim] + 1 == shape[dim]; --dim) {
+                pos -= index[dim] * strides[dim];
+                index[dim] = 0;
+            }
+            if (dim < 0) return;
+            ++index[dim];
+            pos += strides[dim];
         }
-        assert(size == contents.size());
+    }
+
+    // The elements in the row-major order.
+    std::vector<int> getContents() const {
+        if (isContiguous()) {
+            return std::vector<int>(buffer->begin() + offset, buffer->begin() + offset + size());
+        }
+        std::vector<int> result;
+        result.reserve(size());
+        forEach([&result](int value) {result.push_back(value);});
+        return result;
+    }
+
+    bool isContiguous() const {
+        return strides == getRowMajorStrides(shape);
+    }
+
+    // The matrix with the same elements in the row-major order and shape "new_shape". The buffer is copied only if
+    // this matrix is not contiguous.
+    Matrix reshape(std::vector<int> new_shape) const {
+        Matrix result = isContiguous() ? *this : Matrix(getContents(), shape);
+        result.strides = getRowMajorStrides(new_shape);
+        result.shape = std::move(new_shape);
+#ifdef DEBUG
+        assert(result.size() == size());
 #endif
+        return result;
     }
-    virtual Value* copy() const {return new MatrixValue(contents, shape);}
-    virtual ~MatrixValue() = default;
+
+    // The matrix whose i-th dimension is the "perm[i]"-th dimension of this matrix.
+    Matrix permute(const std::vector<int>& perm) const {
+        Matrix result = *this;
+        for (int i = 0; i < perm.size(); ++i) {
+            result.shape[i] = shape[perm[i]];
+            result.strides[i] = strides[perm[i]];
+        }
+        return result;
+    }
+
+    // The matrix with the order of indices on dimension "dim" reversed.
+    Matrix flip(int dim) const {
+        Matrix result = *this;
+        result.offset += (shape[dim] - 1) * strides[dim];
+        result.strides[dim] = -strides[dim];
+        return result;
+    }
+
+    bool operator == (const Matrix& matrix) const {
+        if (shape != matrix.shape) return false;
+        if (buffer == matrix.buffer && offset == matrix.offset && strides == matrix.strides) return true;
+        auto contents = matrix.getContents();
+        int pos = 0;
+        bool result = true;
+        forEach([&](int value) {result = result && value == contents[pos++];});
+        return result;
+    }
+
     std::string toString() const {
         std::string result = "{";
-        for (int i = 0; i < contents.size(); ++i) {
-            result += std::to_string(contents[i]) + ",";
-        }
+        forEach([&result](int value) {result += std::to_string(value) + ",";});
         result += "}@{";
         for (int i: shape) {
             result += std::to_string(i) + ",";
@@ -77,7 +157,6 @@ public:
         result += "}";
         return result;
     }
-    Matrix getValue() const {return Matrix(contents, shape);}
 };
 
 
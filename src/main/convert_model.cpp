@@ -0,0 +1,43 @@
+//
+// Convert a json model produced by "train/python" into the binary format loaded by "ContextInfoMap", and compare the
+// time costs of loading the two formats.
+//
+
+#include "context.h"
+
+#include <chrono>
+#include <gflags/gflags.h>
+#include <iostream>
+
+DEFINE_string(model, "", "The path of the json model");
+DEFINE_string(oup, "", "The path of the resulting binary model");
+DEFINE_int32(benchmark, 0, "The number of times each format is loaded to measure the load time (0 to skip)");
+
+namespace {
+    // The average time cost (in milliseconds) of loading and querying a model.
+    double getLoadTime(const std::string& file_name, int repeat_num) {
+        auto start_time = std::chrono::steady_clock::now();
+        for (int i = 0; i < repeat_num; ++i) {
+            auto* info_map = new ContextInfoMap(file_name);
+            TopDownContext context(std::vector<std::string>(info_map->context_depth, "None"));
+            info_map->getContextInfo(&context);
+            delete info_map;
+        }
+        std::chrono::duration<double, std::milli> duration = std::chrono::steady_clock::now() - start_time;
+        return duration.count() / repeat_num;
+    }
+}
+
+int main(int argc, char** argv) {
+    gflags::ParseCommandLineFlags(&argc, &argv, true);
+    assert(!FLAGS_model.empty() && !FLAGS_oup.empty());
+    auto* info_map = new ContextInfoMap(FLAGS_model);
+    info_map->save(FLAGS_oup);
+    std::cout << "Converted " << info_map->size() << " contexts into " << FLAGS_oup << std::endl;
+    delete info_map;
+    if (FLAGS_benchmark > 0) {
+        std::cout << "json: " << getLoadTime(FLAGS_model, FLAGS_benchmark) << "ms" << std::endl;
+        std::cout << "binary: " << getLoadTime(FLAGS_oup, FLAGS_benchmark) << "ms" << std::endl;
+    }
+    return 0;
+}
@@ -2,22 +2,161 @@
 // Created by pro on 2020/1/21.
 //
 
-#include "context.h"
-#include "specification.h"
-#include "specification_parser.h"
-#include "minimal_context_graph.h"
-#include "solver.h"
+#include "synthesizer.h"
+#include "config.h"
 
-#include <ctime>
+#include <chrono>
 #include <gflags/gflags.h>
 #include <glog/logging.h>
 #include <iostream>
+#include <fstream>
+#include <sstream>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
 
 DEFINE_string(spec, "", "The path of the specification");
 DEFINE_string(model,  "", "The path of the probabilistic model");
 DEFINE_string(oup, "", "The path of the output file");
 DEFINE_string(log, "", "The path of the log file");
 DEFINE_string(type, "string", "The type of the benchmark (string/matrix)");
+DEFINE_int32(thread, 1, "The number of threads used to evaluate witness functions");
+DEFINE_int32(eval_cache_size, 1 << 16, "The max number of outputs of sub-programs memoized in each evaluation cache");
+DEFINE_bool(parallel_search, false, "Whether to explore candidate programs in parallel (requires --thread > 1)");
+DEFINE_bool(divide_ite, false, "Whether to synthesize conditional programs by learning decision trees over terms");
+DEFINE_bool(serve, false, "Whether to serve a stream of requests \"<spec> [<model>]\", one per line, from stdin or --socket");
+DEFINE_string(socket, "", "The path of the unix domain socket listened by --serve");
+DEFINE_string(portfolio, "", "Configurations \"<model>[:<default_p>[:<value_limit>]]\" separated by ';' to run in parallel, "
+                             "where an empty model stands for --model");
+
+namespace {
+    // The state kept by "--serve" across requests. Models are cached by their paths, and graphs are cached by their
+    // models and the keys of their grammars (see "MinimalContextGraph::getGrammarKey").
+    class Server {
+        std::string benchmark_type;
+        std::unordered_map<std::string, ContextInfoMap*> model_cache;
+        std::map<std::pair<std::string, std::string>, MinimalContextGraph*> graph_cache;
+        SynthesisOption option;
+
+    public:
+        Server(const std::string& _benchmark_type, const SynthesisOption& _option):
+            benchmark_type(_benchmark_type), option(_option) {}
+
+        // Solve the task in a request line "<spec> [<model>]". The response is a line of tab-separated fields: the
+        // result program, the CPU time of synthesis, the wall-clock time of the whole request, and whether the graph is
+        // reused ("cached" or "built"). Invalid requests and requests without a valid program are responded with a
+        // line starting with "Error:".
+        std::string handle(const std::string& request) {
+            std::stringstream request_stream(request);
+            std::string spec_file, model_file = FLAGS_model;
+            request_stream >> spec_file >> model_file;
+            if (!std::ifstream(spec_file)) return "Error: cannot open " + spec_file;
+            if (!std::ifstream(model_file)) return "Error: cannot open " + model_file;
+            auto start_time = std::chrono::steady_clock::now();
+
+            // Each request is solved in a new context, and only the models and the graphs are kept.
+            SolverContext context;
+            SolverContextGuard guard(&context);
+            auto* spec = synthesizer::loadTask(spec_file, benchmark_type);
+            if (spec == nullptr) return "Error: cannot parse " + spec_file;
+            auto model_it = model_cache.find(model_file);
+            if (model_it == model_cache.end()) {
+                model_it = model_cache.insert({model_file, synthesizer::loadModel(model_file)}).first;
+            }
+            context.KContextDepth = model_it->second->context_depth;
+            auto graph_key = std::make_pair(model_file, MinimalContextGraph::getGrammarKey(spec->start_terminal));
+            auto graph_it = graph_cache.find(graph_key);
+            bool is_cached = graph_it != graph_cache.end();
+            if (!is_cached) {
+                graph_it = graph_cache.insert({graph_key, synthesizer::buildGraph(spec, model_it->second)}).first;
+            }
+
+            double time_cost;
+            auto* result = synthesizer::synthesize(graph_it->second, spec, option, time_cost);
+            std::string response = "Error: no valid program found";
+            if (result != nullptr) {
+                auto total_time = std::chrono::steady_clock::now() - start_time;
+                double total_time_cost = std::chrono::duration<double>(total_time).count();
+                response = result->toString() + "\t" + std::to_string(time_cost) + "\t" +
+                           std::to_string(total_time_cost) + "\t" + (is_cached ? "cached" : "built");
+                delete result;
+            }
+            // A newly cached graph refers to the rules of this specification, which are thus kept with the graph.
+            if (is_cached) delete spec;
+            return response;
+        }
+
+        void serve(std::istream& inp, std::ostream& oup) {
+            std::string request;
+            while (std::getline(inp, request)) {
+                if (request.find_first_not_of(" \t\r") == std::string::npos) continue;
+                oup << handle(request) << std::endl;
+            }
+        }
+
+        void serve(int fd) {
+            FILE* inp = fdopen(fd, "r");
+            FILE* oup = fdopen(dup(fd), "w");
+            char* line = nullptr;
+            size_t capacity = 0;
+            while (getline(&line, &capacity, inp) != -1) {
+                std::string request(line);
+                if (request.find_first_not_of(" \t\r\n") == std::string::npos) continue;
+                fprintf(oup, "%s\n", handle(request).c_str());
+                fflush(oup);
+            }
+            free(line);
+            fclose(inp);
+            fclose(oup);
+        }
+    };
+
+    // Parse the configurations in "--portfolio". Models used by several configurations are loaded only once.
+    std::vector<PortfolioConfig> parsePortfolio(const std::string& portfolio, const SynthesisOption& option) {
+        std::vector<PortfolioConfig> config_list;
+        std::unordered_map<std::string, ContextInfoMap*> model_map;
+        std::stringstream portfolio_stream(portfolio);
+        std::string config_string;
+        while (std::getline(portfolio_stream, config_string, ';')) {
+            if (config_string.empty()) continue;
+            std::vector<std::string> field_list;
+            std::stringstream config_stream(config_string);
+            std::string field;
+            while (std::getline(config_stream, field, ':')) field_list.push_back(field);
+            PortfolioConfig config;
+            config.name = config_string;
+            std::string model_file = field_list.empty() || field_list[0].empty() ? FLAGS_model : field_list[0];
+            if (model_map.count(model_file) == 0) model_map[model_file] = synthesizer::loadModel(model_file);
+            config.info_map = model_map[model_file];
+            config.default_p = field_list.size() > 1 && !field_list[1].empty() ? std::stod(field_list[1]) : config::KDefaultP;
+            config.option = option;
+            if (field_list.size() > 2 && !field_list[2].empty()) config.option.value_limit = std::stod(field_list[2]);
+            config_list.push_back(config);
+        }
+        return config_list;
+    }
+
+    void serveSocket(Server& server, const std::string& socket_path) {
+        sockaddr_un address = {};
+        address.sun_family = AF_UNIX;
+        if (socket_path.length() >= sizeof(address.sun_path)) {
+            LOG(ERROR) << "The socket path is too long: " << socket_path << std::endl;
+            return;
+        }
+        strcpy(address.sun_path, socket_path.c_str());
+        unlink(socket_path.c_str());
+        int listen_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (listen_fd < 0 || bind(listen_fd, (sockaddr*)(&address), sizeof(address)) != 0 || listen(listen_fd, 16) != 0) {
+            LOG(ERROR) << "Failed to listen on " << socket_path << std::endl;
+            return;
+        }
+        LOG(INFO) << "Listening on " << socket_path << std::endl;
+        while (true) {
+            int fd = accept(listen_fd, nullptr, nullptr);
+            if (fd >= 0) server.serve(fd);
+        }
+    }
+}
 
 int main(int argc, char** argv) {
     google::ParseCommandLineFlags(&argc, &argv, true);
@@ -28,8 +167,8 @@ int main(int argc, char** argv) {
     std::string output_file = FLAGS_oup;
     std::string log_file = FLAGS_log;
     std::string benchmark_type = FLAGS_type;
-    if (benchmark_type == "matrix") {
-        global::isMatrix = true;
+    if (FLAGS_thread > 1) {
+        global::thread_pool = new ThreadPool(FLAGS_thread);
     }
 
     if (!log_file.empty()) {
@@ -38,32 +177,44 @@ int main(int argc, char** argv) {
         FLAGS_logtostderr = true;
     }
 
-    LOG(INFO) << "Parsing the specification from " << spec_file << " with type " << benchmark_type << std::endl;
-    Specification* spec = parser::loadSpecification(spec_file, benchmark_type);
-    LOG(INFO) << "Finished. Example num: " << spec->example_space.size() << std::endl;
-
-    LOG(INFO) << "Parsing the topdown prediction model from " << model_file << std::endl;
-    auto* info_map = new ContextInfoMap(model_file);
-    LOG(INFO) << "Finished. Context num: " << info_map->info_list.size() << std::endl;
-
-    LOG(INFO) << "Building the transition graph of contexts and calculating the initial heuristic value" << std::endl;
-    auto* graph = new MinimalContextGraph(spec->start_terminal, new TopDownContextMaintainer(), info_map);
-    LOG(INFO) << "Finished" << std::endl;
-
-    LOG(INFO) << "Synthesizing" << std::endl;
-    auto start_time = clock();
-    SynthesisTask task(graph, spec);
-    auto* result = task.solve();
-    double time_cost = (clock() - start_time) * 1.0 / CLOCKS_PER_SEC;
-    LOG(INFO) << "Result: " << result->toString() << std::endl;
-    LOG(INFO) << "Time Cost: " << time_cost << std::endl;
+    SynthesisOption option;
+    option.is_parallel_search = FLAGS_parallel_search;
+    option.is_divide_mode = FLAGS_divide_ite;
+    option.eval_cache_size = FLAGS_eval_cache_size;
+
+    if (FLAGS_serve) {
+        Server server(benchmark_type, option);
+        if (FLAGS_socket.empty()) server.serve(std::cin, std::cout);
+        else serveSocket(server, FLAGS_socket);
+        return 0;
+    }
+
+    Specification* spec = synthesizer::loadTask(spec_file, benchmark_type);
+    if (spec == nullptr) return 1;
+    Program* result = nullptr;
+    double time_cost;
+    // The configuration that found the result in the portfolio mode.
+    std::string winner_name;
+    if (!FLAGS_portfolio.empty()) {
+        auto config_list = parsePortfolio(FLAGS_portfolio, option);
+        int winner;
+        result = synthesizer::solvePortfolio(spec, config_list, winner, time_cost);
+        if (winner != -1) winner_name = config_list[winner].name;
+    } else {
+        auto* info_map = synthesizer::loadModel(model_file);
+        auto* graph = synthesizer::buildGraph(spec, info_map);
+        result = synthesizer::synthesize(graph, spec, option, time_cost);
+    }
+    // Nothing is written if no program is found.
+    if (result == nullptr) return 0;
     if (!output_file.empty()) {
         auto *F = std::fopen(output_file.c_str(), "w");
         fprintf(F, "%s\n", result->toString().c_str());
         fprintf(F, "%.10lf\n", time_cost);
+        if (!winner_name.empty()) fprintf(F, "%s\n", winner_name.c_str());
     } else if (!log_file.empty()) {
         std::cout << "Result: " << result->toString() << std::endl;
         std::cout << "Time Cost: " << time_cost << std::endl;
+        if (!winner_name.empty()) std::cout << "Winner: " << winner_name << std::endl;
     }
 } 
-
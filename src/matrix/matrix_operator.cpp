@@ -2,51 +2,70 @@
 #include "config.h"
 
 #include <cstring>
+#include <algorithm>
 
 namespace {
-    void searchForFactor(int rem, std::vector<int>& current, std::vector<std::vector<int>>& result) {
+    void searchForFactor(int rem, const std::vector<int>& int_const, int max_dim, std::vector<int>& current,
+            std::vector<std::vector<int>>& result) {
         if (rem == 1 && current.size() > 1) {
             result.push_back(current);
         }
-        if (current.size() == global::KMaxDim) return;
-        for (int dim_size: global::string_info->int_const) {
+        if (current.size() == max_dim) return;
+        for (int dim_size: int_const) {
             if (dim_size <= 1) continue;
             if (rem % dim_size == 0) {
                 current.push_back(dim_size);
-                searchForFactor(rem / dim_size, current, result);
+                searchForFactor(rem / dim_size, int_const, max_dim, current, result);
                 current.pop_back();
             }
         }
     }
 
-    std::vector<int> subsize_list;
-    int id;
+    std::vector<std::vector<int>> getAllShapes(int size, const std::vector<int>& int_const, int max_dim) {
+        std::vector<std::vector<int>> result = {{1, size}};
+        std::vector<int> current;
+        searchForFactor(size, int_const, max_dim, current, result);
+        return result;
+    }
 
-    void initSubsizeList(std::vector<int> shape) {
-        subsize_list.resize(shape.size());
-        int dim_num = shape.size();
-        subsize_list[dim_num - 1] = 1;
-        for (int i = dim_num - 2; i >= 0; --i) {
-            subsize_list[i] = subsize_list[i + 1] * shape[i + 1];
+    // Enumerate all "perm" such that "shape" permuted by "perm" is "target": the j-th dimension of the result can only
+    // come from a dimension of "shape" with the extent "target[j]".
+    void searchForPermutation(int pos, const std::vector<int>& shape, const std::vector<int>& target,
+            std::vector<int>& perm, std::vector<bool>& is_used, std::vector<std::vector<int>>& result) {
+        if (pos == shape.size()) {
+            result.push_back(perm);
+            return;
+        }
+        for (int i = 0; i < shape.size(); ++i) {
+            if (is_used[i] || shape[i] != target[pos]) continue;
+            is_used[i] = true; perm[pos] = i;
+            searchForPermutation(pos + 1, shape, target, perm, is_used, result);
+            is_used[i] = false;
         }
     }
 }
 
+ShapeTable::ShapeTable(const std::vector<int> &size_list, const std::vector<int> &_int_const, int _max_dim):
+    int_const(_int_const), max_dim(_max_dim) {
+    for (int value: int_const) const_set.insert(value);
+    for (int size: size_list) {
+        if (shape_map.find(size) != shape_map.end()) continue;
+        auto& shape_list = shape_map[size] = getAllShapes(size, int_const, max_dim);
+        shape_num += shape_list.size();
+    }
+}
+
+std::vector<std::vector<int>> ShapeTable::getShapeList(int size) const {
+    auto it = shape_map.find(size);
+    if (it != shape_map.end()) return it->second;
+    return getAllShapes(size, int_const, max_dim);
+}
+
 Data ReshapeSemantics::run(const DataList &inp, GlobalInfo *global_info) {
 #ifdef DEBUG
     check(inp);
 #endif
-    auto matrix = inp[0].getMatrix();
-    auto shape = inp[1].getMatrix().contents;
-#ifdef DEBUG
-    int size = matrix.contents.size();
-    int new_size = 1;
-    for (auto dim_size: shape) {
-        new_size *= dim_size;
-    }
-    assert(size == new_size);
-#endif
-    return Data(new MatrixValue(inp[0].getMatrix().contents, shape));
+    return Data(inp[0].getMatrix().reshape(inp[1].getMatrix().getContents()));
 }
 
 WitnessList ReshapeSemantics::witnessFunction(const DataList &oup, GlobalInfo *global_info) {
@@ -54,59 +73,61 @@ WitnessList ReshapeSemantics::witnessFunction(const DataList &oup, GlobalInfo *g
     assert(oup.size() == 1);
 #endif
     int current_size = 1;
-    Matrix matrix = oup[0].getMatrix();
+    const Matrix& matrix = oup[0].getMatrix();
     for (int dim_size: matrix.shape) {
         current_size = current_size * dim_size;
     }
-    std::vector<std::vector<int>> factor_schemes = {{1, current_size}};
-    std::vector<int> current_scheme;
-    searchForFactor(current_size, current_scheme, factor_schemes);
+    auto& shape_table = global::context->string_info->shape_table;
+    auto factor_schemes = shape_table ? shape_table->getShapeList(current_size) :
+            getAllShapes(current_size, global::context->string_info->int_const, global::context->KMaxDim);
     WitnessList result;
     for (auto& shape: factor_schemes) {
         if (shape == matrix.shape) continue;
-        result.push_back({{Data(new MatrixValue(matrix.contents, shape))},
-                          {Data(new MatrixValue(matrix.shape, {int(matrix.shape.size())}))}});
+        result.push_back({{Data(matrix.reshape(shape))},
+                          {Data(Matrix(matrix.shape, {int(matrix.shape.size())}))}});
     }
     return result;
 }
 
-void PermuteSemantics::permuteIndex(int pos, const std::vector<int> &perm, const Matrix &matrix,
-                                    int current_index, std::vector<int> &result) {
-    if (pos == perm.size()) {
-        result[id++] = matrix.contents[current_index];
-        return;
-    }
-    int current_dim = perm[pos];
-    int current_size = matrix.shape[current_dim];
-    for (int i = 0; i < current_size; ++i) {
-        permuteIndex(pos + 1, perm, matrix, current_index, result);
-        current_index += subsize_list[perm[pos]];
-    }
-}
-
 WitnessList PermuteSemantics::witnessFunction(const DataList &oup, GlobalInfo *global_info) {
 #ifdef DEBUG
     assert(oup.size() == 1);
 #endif
+    const Matrix& matrix = oup[0].getMatrix();
+    int dim_num = matrix.shape.size();
+    // The second input lists every dimension id, so no permutation can be built if some id is not a constant.
+    auto& shape_table = global::context->string_info->shape_table;
+    auto& int_const = global::context->string_info->int_const;
+    for (int i = 0; i < dim_num; ++i) {
+        if (shape_table ? !shape_table->isConst(i) :
+                std::find(int_const.begin(), int_const.end(), i) == int_const.end()) return {};
+    }
+    // For each permutation "perm", the input is "matrix" permuted by "perm", which is a view built in O(dims), and
+    // permuting it by the inverse of "perm" gives "matrix". Permute, Fliplr and Flipud may build a matrix in any
+    // arrangement of its extents, so every arrangement is a candidate shape of the input, and the permutations leading
+    // to each of them are found by matching extents.
+    std::vector<std::vector<int>> target_list;
+    std::vector<int> target = matrix.shape;
+    std::sort(target.begin(), target.end());
+    do target_list.push_back(target); while (std::next_permutation(target.begin(), target.end()));
+    std::vector<std::vector<int>> perm_list;
+    std::vector<int> perm(dim_num);
+    std::vector<bool> is_used(dim_num, false);
+    for (auto& target: target_list) {
+        searchForPermutation(0, matrix.shape, target, perm, is_used, perm_list);
+    }
+    std::sort(perm_list.begin(), perm_list.end());
     WitnessList result;
-    std::vector<int> perm;
-    auto matrix = oup[0].getMatrix();
-    for (int i = 0; i < matrix.shape.size(); ++i) {
-        perm.push_back(i);
-    }
-    std::vector<int> new_content(matrix.contents.size());
-    std::vector<int> reversed_perm(perm.size());
-    std::vector<int> new_shape(perm.size());
-    initSubsizeList(matrix.shape);
-    while (std::next_permutation(perm.begin(), perm.end())) {
-        id = 0;
-        permuteIndex(0, perm, matrix, 0, new_content);
-        for (int i = 0; i < perm.size(); ++i) {
-            reversed_perm[perm[i]] = i;
-            new_shape[i] = matrix.shape[perm[i]];
+    std::vector<int> reversed_perm(dim_num);
+    for (auto& current_perm: perm_list) {
+        bool is_identity = true;
+        for (int i = 0; i < dim_num; ++i) {
+            reversed_perm[current_perm[i]] = i;
+            if (current_perm[i] != i) is_identity = false;
         }
-        result.push_back({{Data(new MatrixValue(new_content, new_shape))},
-                          {Data(new MatrixValue(reversed_perm, {int(new_shape.size())}))}});
+        if (is_identity) continue;
+        result.push_back({{Data(matrix.permute(current_perm))},
+                          {Data(Matrix(reversed_perm, {dim_num}))}});
     }
     return result;
 }
@@ -115,26 +136,16 @@ Data PermuteSemantics::run(const DataList &inp, GlobalInfo *global_info) {
 #ifdef DEBUG
     check(inp);
 #endif
-    auto matrix = inp[0].getMatrix();
-    auto perm = inp[1].getMatrix().contents;
+    const Matrix& matrix = inp[0].getMatrix();
+    auto perm = inp[1].getMatrix().getContents();
 #ifdef DEBUG
     assert(perm.size() == matrix.shape.size());
-    static int pd[10];
-    memset(pd, 0x00, sizeof pd);
+    int pd[10] = {};
     for (int dim: perm) {
         assert(pd[dim] == 0); pd[dim] = 1;
     }
 #endif
-    std::vector<int> new_content(matrix.contents.size());
-    std::vector<int> index(perm.size());
-    std::vector<int> new_shape(perm.size());
-    for (int i = 0; i < perm.size(); ++i) {
-        new_shape[i] = matrix.shape[perm[i]];
-    }
-    id = 0;
-    initSubsizeList(matrix.shape);
-    permuteIndex(0, perm, matrix, 0, new_content);
-    return Data(new MatrixValue(new_content, new_shape));
+    return Data(matrix.permute(perm));
 }
 
 Data MatrixIDSemantics::run(const DataList &inp, GlobalInfo *global_info) {
@@ -151,55 +162,13 @@ WitnessList MatrixIDSemantics::witnessFunction(const DataList &oup, GlobalInfo *
     return {{oup}};
 }
 
-void FliplrSemantics::flipLR(int pos, const Matrix &matrix, std::vector<int> &init_dim, std::vector<int> &result) {
-    if (pos == matrix.shape.size()) {
-        int init_pos = 0;
-        for (int i = 0; i < matrix.shape.size(); ++i) {
-            init_pos = init_pos * matrix.shape[i] + init_dim[i];
-        }
-        result.push_back(matrix.contents[init_pos]);
-        return;
-    }
-    if (pos == 1) {
-        for (int i = matrix.shape[pos] - 1; i >= 0; --i) {
-            init_dim[pos] = i;
-            flipLR(pos + 1, matrix, init_dim, result);
-        }
-    } else {
-        for (int i = 0; i < matrix.shape[pos]; ++i) {
-            init_dim[pos] = i;
-            flipLR(pos + 1, matrix, init_dim, result);
-        }
-    }
-}
-
 Data FliplrSemantics::run(const DataList &inp, GlobalInfo * global_info) {
 #ifdef DEBUG
     check(inp);
 #endif
-    Matrix matrix = inp[0].getMatrix();
+    const Matrix& matrix = inp[0].getMatrix();
     assert(matrix.shape.size() >= 2);
-    std::vector<int> new_content(matrix.contents.size());
-    std::vector<int> index(matrix.shape.size());
-    int sub_size = 1;
-    for (int i = 2; i < matrix.shape.size(); ++i) {
-        sub_size *= matrix.shape[i];
-    }
-    int reversed_id = matrix.shape[1] - 1;
-    int bias = 0;
-    for (int i = 0; i < matrix.contents.size(); ++i) {
-        if (i % sub_size == 0) {
-            reversed_id += 1;
-            if (reversed_id == matrix.shape[1]) {
-                reversed_id = 0;
-                bias = (matrix.shape[1] - 1) * sub_size;
-            } else {
-                bias -= (sub_size << 1);
-            }
-        }
-        new_content[bias + i] = matrix.contents[i];
-    }
-    return Data(new MatrixValue(new_content, matrix.shape));
+    return Data(matrix.flip(1));
 }
 
 WitnessList FliplrSemantics::witnessFunction(const DataList &oup, GlobalInfo *global_info) {
@@ -209,48 +178,11 @@ WitnessList FliplrSemantics::witnessFunction(const DataList &oup, GlobalInfo *gl
     return {{{run(oup, global_info)}}};
 }
 
-void FlipudSemantics::flipUD(int pos, const Matrix &matrix, std::vector<int> &init_dim, std::vector<int> &result) {
-    if (pos == matrix.shape.size()) {
-        int init_pos = 0;
-        for (int i = 0; i < matrix.shape.size(); ++i) {
-            init_pos = init_pos * matrix.shape[i] + init_dim[i];
-        }
-        result.push_back(matrix.contents[init_pos]);
-        return;
-    }
-    if (pos == 0) {
-        for (int i = matrix.shape[pos] - 1; i >= 0; --i) {
-            init_dim[pos] = i;
-            flipUD(pos + 1, matrix, init_dim, result);
-        }
-    } else {
-        for (int i = 0; i < matrix.shape[pos]; ++i) {
-            init_dim[pos] = i;
-            flipUD(pos + 1, matrix, init_dim, result);
-        }
-    }
-}
-
 Data FlipudSemantics::run(const DataList &inp, GlobalInfo *global_info) {
 #ifdef DEBUG
     check(inp);
 #endif
-    Matrix matrix = inp[0].getMatrix();
-    std::vector<int> new_content(matrix.contents.size());
-    std::vector<int> index(matrix.shape.size());
-    int sub_size = 1;
-    for (int i = 1; i < matrix.shape.size(); ++i) {
-        sub_size *= matrix.shape[i];
-    }
-    int bias = (matrix.shape[0] - 1) * sub_size;
-    for (int i = 0; i < matrix.contents.size(); ++i) {
-        if (i % sub_size == 0 && i) {
-            bias -= (sub_size << 1);
-        }
-        new_content[bias + i] = matrix.contents[i];
-    }
-    // flipUD(0, matrix, index, new_content);
-    return Data(new MatrixValue(new_content, matrix.shape));
+    return Data(inp[0].getMatrix().flip(0));
 }
 
 WitnessList FlipudSemantics::witnessFunction(const DataList &oup, GlobalInfo *global_info) {
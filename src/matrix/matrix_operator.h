@@ -2,6 +2,27 @@
 #define L2S_MATRIX_OPERATOR_H
 
 #include "semantics.h"
+#include "config.h"
+
+#include <unordered_map>
+#include <unordered_set>
+
+// All shapes that a matrix with a given number of elements may be reshaped into: {1, size} and all shapes with at
+// most "max_dim" dimensions whose sizes are integer constants larger than 1. The table is built once per task, and
+// witness functions read it instead of factorizing sizes on every invocation.
+class ShapeTable {
+    std::unordered_map<int, std::vector<std::vector<int>>> shape_map;
+    std::unordered_set<int> const_set;
+    std::vector<int> int_const;
+    int max_dim, shape_num = 0;
+public:
+    ShapeTable(const std::vector<int>& size_list, const std::vector<int>& _int_const, int _max_dim);
+    // Shapes are listed in a fixed order, so that witnesses are generated deterministically.
+    std::vector<std::vector<int>> getShapeList(int size) const;
+    bool isConst(int value) const {return const_set.find(value) != const_set.end();}
+    int getSizeNum() const {return shape_map.size();}
+    int getShapeNum() const {return shape_num;}
+};
 
 // All operators used in the matrix domain.
 class ReshapeSemantics: public Semantics {
@@ -12,7 +33,6 @@ public:
 };
 
 class PermuteSemantics: public Semantics {
-    void permuteIndex(int pos, const std::vector<int>& perm, const Matrix& matrix, int current_index, std::vector<int>& result);
 public:
     PermuteSemantics(): Semantics({TMATRIX, TMATRIX}, TMATRIX, "Permute") {}
     virtual Data run(const DataList &inp, GlobalInfo *global_info);
@@ -27,7 +47,6 @@ public:
 };
 
 class FliplrSemantics: public Semantics {
-    void flipLR(int pos, const Matrix& matrix, std::vector<int>& init_dim, std::vector<int>& result);
 public:
     FliplrSemantics(): Semantics({TMATRIX}, {TMATRIX}, "Fliplr") {}
     virtual Data run(const DataList &inp, GlobalInfo *global_info);
@@ -35,7 +54,6 @@ public:
 };
 
 class FlipudSemantics: public Semantics {
-    void flipUD(int pos, const Matrix& matrix, std::vector<int>& init_dim, std::vector<int>& result);
 public:
     FlipudSemantics(): Semantics({TMATRIX}, {TMATRIX}, "Flipud") {}
     virtual Data run(const DataList &inp, GlobalInfo *global_info);
@@ -49,18 +67,20 @@ public:
 #ifdef DEBUG
         check(inp);
 #endif
-        return Data(new MatrixValue({inp[0].getInt(), inp[1].getInt()}, {2}));
+        return Data(Matrix({inp[0].getInt(), inp[1].getInt()}, {2}));
     }
     virtual WitnessList witnessFunction(const DataList &oup, GlobalInfo *global_info) {
 #ifdef DEBUG
         assert(oup.size() == 1);
 #endif
-        auto matrix = oup[0].getMatrix();
+        auto contents = oup[0].getMatrix().getContents();
 #ifdef DEBUG
-        assert(matrix.shape.size() == 1 && matrix.contents.size() >= 2);
+        assert(oup[0].getMatrix().shape.size() == 1 && contents.size() >= 2);
 #endif
-        if (matrix.contents.size() > 2) return {};
-        return {{{Data(new IntValue(matrix.contents[0]))}, {Data(new IntValue(matrix.contents[1]))}}};
+        if (contents.size() > 2) return {};
+        auto& shape_table = global::context->string_info->shape_table;
+        if (shape_table && (!shape_table->isConst(contents[0]) || !shape_table->isConst(contents[1]))) return {};
+        return {{{Data(contents[0])}, {Data(contents[1])}}};
     }
 };
 
@@ -71,31 +91,28 @@ public:
 #ifdef DEBUG
         check(inp);
 #endif
-        auto matrix = inp[1].getMatrix();
+        const Matrix& matrix = inp[1].getMatrix();
 #ifdef DEBUG
-        assert(matrix.shape.size() == 1 && matrix.contents.size() >= 2);
+        assert(matrix.shape.size() == 1 && matrix.size() >= 2);
 #endif
         std::vector<int> new_contents = {inp[0].getInt()};
-        for (int value: matrix.contents) {
-            new_contents.push_back(value);
-        }
-        return Data(new MatrixValue(new_contents, {matrix.shape[0] + 1}));
+        matrix.forEach([&new_contents](int value) {new_contents.push_back(value);});
+        return Data(Matrix(std::move(new_contents), {matrix.shape[0] + 1}));
     }
     virtual WitnessList witnessFunction(const DataList &oup, GlobalInfo *global_info) {
 #ifdef DEBUG
         assert(oup.size() == 1);
 #endif
-        auto matrix = oup[0].getMatrix();
+        auto contents = oup[0].getMatrix().getContents();
 #ifdef DEBUG
-        assert(matrix.shape.size() == 1 && matrix.contents.size() >= 2);
+        assert(oup[0].getMatrix().shape.size() == 1 && contents.size() >= 2);
 #endif
-        if (matrix.contents.size() == 2) return {};
-        std::vector<int> new_contents;
-        for (int i = 1; i < matrix.contents.size(); ++i) {
-            new_contents.push_back(matrix.contents[i]);
-        }
-        return {{{Data(new IntValue(matrix.contents[0]))},
-                 {Data(new MatrixValue(new_contents, {matrix.shape[0] - 1}))}}};
+        if (contents.size() == 2) return {};
+        auto& shape_table = global::context->string_info->shape_table;
+        if (shape_table && !shape_table->isConst(contents[0])) return {};
+        std::vector<int> new_contents(contents.begin() + 1, contents.end());
+        return {{{Data(contents[0])},
+                 {Data(Matrix(std::move(new_contents), {int(contents.size()) - 1}))}}};
     }
 
 };
@@ -1,8 +1,12 @@
 #include "specification_parser.h"
 #include "semantics_factory.h"
 #include "config.h"
+#include "sygus_parser.h"
+#include <atomic>
 #include <cstring>
+#include <unistd.h>
 #include <iostream>
+#include <glog/logging.h>
 
 namespace {
     std::vector<int> extractAllInt(std::string s) {
@@ -40,7 +44,7 @@ namespace {
             }
         }
         if (is_number) {
-            return new Program({}, new ConstSemantics(Data(new IntValue(std::stoi(s)))));
+            return new Program({}, new ConstSemantics(Data(std::stoi(s))));
         }
         assert(s[s.length() - 1] == ')');
         int start = 0;
@@ -73,11 +77,11 @@ namespace {
         for (int i = 1; i <= size; ++i) {
             contents.push_back(i);
         }
-        return Data(new MatrixValue(contents, shape));
+        return Data(Matrix(contents, shape));
     }
 
     Specification *loadMatrixSpecification(std::string file_name) {
-        static char ch[5100];
+        char ch[5100];
         std::vector<std::string> info;
         auto* file = fopen(file_name.c_str(), "r");
         while (fgets(ch, 1000, file) != NULL) {
@@ -91,8 +95,8 @@ namespace {
         auto* param = new NonTerminal("param", TMATRIX);
         auto* int_const = new NonTerminal("const", TINT);
         for (int i = 0; i <= 3; ++i) {
-            global::string_info->int_const.push_back(i);
-            int_const->rule_list.push_back(new Rule(new ConstSemantics(Data(new IntValue(i))), {}));
+            global::context->string_info->int_const.push_back(i);
+            int_const->rule_list.push_back(new Rule(new ConstSemantics(Data(i)), {}));
         }
 
         param->rule_list.push_back(new Rule(new ParamSemantics(0, TMATRIX), {}));
@@ -107,12 +111,12 @@ namespace {
         Specification* specification = new Specification();
         specification->start_terminal = start;
         specification->return_type = TMATRIX;
-        global::spec_type = S_PBE;
+        global::context->spec_type = S_PBE;
 
         std::vector<int> size_list = extractAllInt(info[1]);
         int tot = 1;
         for (int size: size_list) tot *= size;
-        auto& int_list = global::string_info->int_const;
+        auto& int_list = global::context->string_info->int_const;
         std::vector<int> extra = size_list;
         for (int i = 2; i <= 10; ++i) if (tot % i == 0) extra.push_back(i);
         for (int i = 7; i < info.size(); ++i) {
@@ -123,14 +127,14 @@ namespace {
             if (i && tot % i != 0) continue;
             if (std::find(int_list.begin(), int_list.end(), i) == int_list.end()) {
                 int_list.push_back(i);
-                int_const->rule_list.push_back(new Rule(new ConstSemantics(Data(new IntValue(i))), {}));
+                int_const->rule_list.push_back(new Rule(new ConstSemantics(Data(i)), {}));
             }
         }
 
         auto inp = parseMatrix(info[1]);
         Program* program = parseProgram(info[4]);
         auto oup = program->run({inp});
-        global::KMaxDim = std::max(global::KMaxDim, int(std::max(inp.getMatrix().shape.size(), oup.getMatrix().shape.size())));
+        global::context->KMaxDim = std::max(global::context->KMaxDim, int(std::max(inp.getMatrix().shape.size(), oup.getMatrix().shape.size())));
         specification->oracle = program;
 
         specification->example_space.push_back(new Example({inp}, oup));
@@ -142,10 +146,18 @@ Specification* parser::loadSpecification(std::string file_name, std::string benc
     if (benchmark_type == "matrix") {
         return loadMatrixSpecification(file_name);
     }
-    srand(time(0));
-    std::string temp_file = std::to_string(rand()) + ".json";
+    auto* native_spec = loadSyGuSSpecification(file_name);
+    if (native_spec != nullptr) return native_spec;
+    LOG(INFO) << "Fall back to the python parser";
+    // The temporary file is unique among tasks parsed at the same time in this process and in other processes.
+    static std::atomic<int> temp_file_num(0);
+    std::string temp_file = std::to_string(getpid()) + "_" + std::to_string(temp_file_num++) + ".json";
     std::string command = "python3 " + config::KParserMainPath + " " + file_name + " " + benchmark_type + " " + temp_file;
-    system(command.c_str());
+    if (system(command.c_str()) != 0) {
+        LOG(ERROR) << "The python parser failed on " << file_name << std::endl;
+        system(("rm -f " + temp_file).c_str());
+        return nullptr;
+    }
     auto* spec = new Specification(temp_file);
     system(("rm " + temp_file).c_str());
     return spec;
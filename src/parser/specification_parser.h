@@ -5,6 +5,7 @@
 
 // Initialize a specification from a file.
 // If a new type of specification is required, its parser must be implemented in this function.
+// The result is nullptr if the file cannot be parsed by any parser.
 namespace parser {
     extern Specification* loadSpecification(std::string file_name, std::string benchmark_type);
 }
@@ -0,0 +1,301 @@
+#include "sygus_parser.h"
+#include "semantics_factory.h"
+#include "util.h"
+#include "config.h"
+
+#include <cctype>
+#include <limits>
+
+namespace {
+    class SExpReader {
+        const std::string& s;
+        int pos = 0;
+        // Set when the input is not a sequence of well-formed s-expressions, e.g., a list is not closed or an integer
+        // does not fit into "int". The results of "read" are meaningless afterward.
+        bool is_failed = false;
+
+        void skipSpace() {
+            while (pos < s.length()) {
+                if (s[pos] == ';') {
+                    while (pos < s.length() && s[pos] != '\n') ++pos;
+                } else if (isspace((unsigned char)(s[pos]))) {
+                    ++pos;
+                } else return;
+            }
+        }
+
+        static bool isInteger(const std::string& token) {
+            int start = token[0] == '-' ? 1 : 0;
+            if (start == token.length()) return false;
+            for (int i = start; i < token.length(); ++i) {
+                if (!isdigit((unsigned char)(token[i]))) return false;
+            }
+            return true;
+        }
+
+        // Parse an integer token. Return false if it is out of the range of "int".
+        static bool parseInteger(const std::string& token, int& value) {
+            bool is_negative = token[0] == '-';
+            long long result = 0;
+            for (int i = is_negative ? 1 : 0; i < token.length(); ++i) {
+                result = result * 10 + (token[i] - '0');
+                if (result > (long long)(std::numeric_limits<int>::max()) + 1) return false;
+            }
+            if (is_negative) result = -result;
+            if (result > std::numeric_limits<int>::max()) return false;
+            value = result;
+            return true;
+        }
+
+        parser::SExp readString() {
+            parser::SExp result(parser::SExp::STRING);
+            int start = ++pos;
+            while (pos < s.length()) {
+                if (s[pos] == '\\') pos += 2;
+                else if (s[pos] == '"' && pos + 1 < s.length() && s[pos + 1] == '"') pos += 2;
+                else if (s[pos] == '"') break;
+                else ++pos;
+            }
+            if (pos >= s.length()) {
+                is_failed = true;
+                return result;
+            }
+            result.value = s.substr(start, pos - start);
+            ++pos;
+            return result;
+        }
+
+        parser::SExp readToken() {
+            int start = pos;
+            while (pos < s.length() && !isspace((unsigned char)(s[pos])) && s[pos] != '(' && s[pos] != ')'
+                   && s[pos] != '"' && s[pos] != ';') {
+                ++pos;
+            }
+            std::string token = s.substr(start, pos - start);
+            if (isInteger(token)) {
+                parser::SExp result(parser::SExp::INT);
+                result.value = token;
+                if (!parseInteger(token, result.int_value)) is_failed = true;
+                return result;
+            }
+            parser::SExp result(token == "true" || token == "false" ? parser::SExp::BOOL : parser::SExp::SYMBOL);
+            result.value = token;
+            return result;
+        }
+
+    public:
+        SExpReader(const std::string& _s): s(_s) {}
+
+        bool isEnd() {
+            skipSpace();
+            return pos == s.length();
+        }
+
+        bool isFailed() const {return is_failed;}
+
+        parser::SExp read() {
+            skipSpace();
+            if (pos >= s.length() || s[pos] == ')') {
+                is_failed = true;
+                return parser::SExp(parser::SExp::LIST);
+            }
+            if (s[pos] == '"') return readString();
+            if (s[pos] != '(') return readToken();
+            parser::SExp result(parser::SExp::LIST);
+            ++pos;
+            while (!is_failed && (skipSpace(), pos < s.length() && s[pos] != ')')) {
+                result.sub_list.push_back(read());
+            }
+            if (is_failed || pos >= s.length()) {
+                is_failed = true;
+                return result;
+            }
+            ++pos;
+            return result;
+        }
+    };
+
+    bool isSameSExp(const parser::SExp& x, const parser::SExp& y) {
+        if (x.kind != y.kind || x.value != y.value || x.sub_list.size() != y.sub_list.size()) return false;
+        for (int i = 0; i < x.sub_list.size(); ++i) {
+            if (!isSameSExp(x.sub_list[i], y.sub_list[i])) return false;
+        }
+        return true;
+    }
+
+    bool isType(const parser::SExp& node) {
+        return node.isSymbol("Int") || node.isSymbol("String") || node.isSymbol("Bool");
+    }
+
+    Data sexp2Data(const parser::SExp& node) {
+        switch (node.kind) {
+            case parser::SExp::INT: return Data(node.int_value);
+            case parser::SExp::STRING: return Data(node.value);
+            case parser::SExp::BOOL: return Data(node.value == "true");
+            default: assert(0);
+        }
+    }
+
+    // The rules removed by the python parser: integer constants other than -1, 0, 1 and "ite" with an integer
+    // condition.
+    bool isValidRule(const parser::SExp& rule) {
+        if (rule.kind == parser::SExp::INT) return std::abs(rule.int_value) <= 1;
+        if (rule.kind == parser::SExp::LIST && rule.sub_list.size() > 1) {
+            return !(rule.sub_list[0].isSymbol("ite") && rule.sub_list[1].isSymbol("ntInt"));
+        }
+        return true;
+    }
+
+    // Build the grammar of "synth-fun". Return false if it is not in the form supported by the python parser.
+    bool loadGrammar(const parser::SExp& synth_fun, Specification* spec) {
+        if (synth_fun.sub_list.size() != 5) return false;
+        auto& param_root = synth_fun.sub_list[2];
+        auto& return_type = synth_fun.sub_list[3];
+        auto& grammar_root = synth_fun.sub_list[4];
+        if (param_root.kind != parser::SExp::LIST || !isType(return_type)) return false;
+        if (grammar_root.kind != parser::SExp::LIST || grammar_root.sub_list.size() < 2) return false;
+        for (auto& param_node: param_root.sub_list) {
+            if (param_node.sub_list.size() != 2 || param_node.sub_list[0].kind != parser::SExp::SYMBOL ||
+                !isType(param_node.sub_list[1])) {
+                return false;
+            }
+            std::string name = param_node.sub_list[0].value;
+            spec->param_map[name] = spec->param_list.size();
+            spec->param_list.emplace_back(name, util::string2Type(param_node.sub_list[1].value));
+        }
+        spec->return_type = util::string2Type(return_type.value);
+
+        // The start symbol "(Start T (ntT))" is replaced by the non-terminal "ntT".
+        auto& start_root = grammar_root.sub_list[0];
+        if (start_root.sub_list.size() != 3 || !start_root.sub_list[0].isSymbol("Start")) return false;
+        auto& start_rule_list = start_root.sub_list[2].sub_list;
+        if (start_rule_list.size() != 1 || start_rule_list[0].kind != parser::SExp::SYMBOL) return false;
+        std::string true_start = start_rule_list[0].value;
+        if (!start_root.sub_list[1].isSymbol(true_start.substr(std::min(int(true_start.length()), 2)))) return false;
+        auto get_name = [&](const std::string& name) {return name == true_start ? std::string("Start") : name;};
+
+        std::vector<std::pair<NonTerminal*, std::vector<parser::SExp>>> symbol_list;
+        for (int i = 1; i < grammar_root.sub_list.size(); ++i) {
+            auto& symbol_root = grammar_root.sub_list[i];
+            if (symbol_root.sub_list.size() != 3 || symbol_root.sub_list[0].kind != parser::SExp::SYMBOL ||
+                symbol_root.sub_list[0].value == "Start" || !isType(symbol_root.sub_list[1]) ||
+                symbol_root.sub_list[2].kind != parser::SExp::LIST) {
+                return false;
+            }
+            std::string name = get_name(symbol_root.sub_list[0].value);
+            if (spec->non_terminal_map.count(name)) return false;
+            auto* symbol = new NonTerminal(name, util::string2Type(symbol_root.sub_list[1].value));
+            spec->non_terminal_map[name] = symbol;
+            std::vector<parser::SExp> rule_list;
+            for (auto& rule: symbol_root.sub_list[2].sub_list) {
+                if (!isValidRule(rule)) continue;
+                bool is_duplicated = false;
+                for (auto& existing_rule: rule_list) {
+                    if (isSameSExp(existing_rule, rule)) {
+                        is_duplicated = true;
+                        break;
+                    }
+                }
+                if (!is_duplicated) rule_list.push_back(rule);
+            }
+            symbol_list.emplace_back(symbol, rule_list);
+        }
+
+        for (auto& symbol_info: symbol_list) {
+            auto* symbol = symbol_info.first;
+            for (auto& rule: symbol_info.second) {
+                if (rule.isLiteral()) {
+                    symbol->rule_list.push_back(new Rule(new ConstSemantics(sexp2Data(rule)), {}));
+                } else if (rule.kind == parser::SExp::SYMBOL) {
+                    auto it = spec->param_map.find(rule.value);
+                    if (it == spec->param_map.end()) return false;
+                    symbol->rule_list.push_back(new Rule(new ParamSemantics(it->second, spec->param_list[it->second].type), {}));
+                } else {
+                    if (rule.sub_list.empty() || rule.sub_list[0].kind != parser::SExp::SYMBOL) return false;
+                    std::vector<NonTerminal*> param_list;
+                    for (int i = 1; i < rule.sub_list.size(); ++i) {
+                        auto& param = rule.sub_list[i];
+                        if (param.kind != parser::SExp::SYMBOL || param.value == "Start") return false;
+                        auto it = spec->non_terminal_map.find(get_name(param.value));
+                        if (it == spec->non_terminal_map.end()) return false;
+                        param_list.push_back(it->second);
+                    }
+                    symbol->rule_list.push_back(new Rule(string2Semantics(rule.sub_list[0].value), param_list));
+                }
+            }
+        }
+
+        spec->start_terminal = nullptr;
+        for (auto& symbol_pair: spec->non_terminal_map) {
+            if (symbol_pair.first.find("Start") != std::string::npos && symbol_pair.second->type == spec->return_type) {
+                if (spec->start_terminal != nullptr) return false;
+                spec->start_terminal = symbol_pair.second;
+            }
+        }
+        return spec->start_terminal != nullptr;
+    }
+
+    // Parse a constraint "(= (f c1 ... cn) c)" into an example. Return nullptr if it is in any other form.
+    Example* loadExample(const parser::SExp& constraint, const std::string& function_name, int param_num) {
+        if (constraint.sub_list.size() != 2) return nullptr;
+        auto& expr = constraint.sub_list[1];
+        if (expr.sub_list.size() != 3 || !expr.sub_list[0].isSymbol("=")) return nullptr;
+        const parser::SExp* call = &expr.sub_list[1];
+        const parser::SExp* oup = &expr.sub_list[2];
+        if (call->kind != parser::SExp::LIST) std::swap(call, oup);
+        if (call->kind != parser::SExp::LIST || !oup->isLiteral()) return nullptr;
+        if (call->sub_list.size() != param_num + 1 || !call->sub_list[0].isSymbol(function_name)) return nullptr;
+        DataList inp;
+        for (int i = 1; i < call->sub_list.size(); ++i) {
+            if (!call->sub_list[i].isLiteral()) return nullptr;
+            inp.push_back(sexp2Data(call->sub_list[i]));
+        }
+        Data oup_data = sexp2Data(*oup);
+        return new Example(inp, oup_data);
+    }
+}
+
+bool parser::parseSExpFile(const std::string &file_name, std::vector<SExp>& result) {
+    std::string content = util::loadStringFromFile(file_name);
+    SExpReader reader(content);
+    while (!reader.isFailed() && !reader.isEnd()) result.push_back(reader.read());
+    return !reader.isFailed();
+}
+
+Specification * parser::loadSyGuSSpecification(const std::string &file_name) {
+    std::vector<SExp> command_list;
+    if (!parseSExpFile(file_name, command_list)) return nullptr;
+    const SExp* synth_fun = nullptr;
+    for (auto& command: command_list) {
+        if (command.kind != SExp::LIST || command.sub_list.empty()) return nullptr;
+        if (command.sub_list[0].isSymbol("synth-fun")) {
+            if (synth_fun != nullptr) return nullptr;
+            synth_fun = &command;
+        }
+    }
+    if (synth_fun == nullptr || synth_fun->sub_list.size() < 2) return nullptr;
+
+    auto* spec = new Specification();
+    std::string function_name = synth_fun->sub_list[1].value;
+    bool is_valid = loadGrammar(*synth_fun, spec);
+    for (auto& command: command_list) {
+        if (!is_valid) break;
+        if (command.sub_list[0].isSymbol("declare-var")) {
+            if (command.sub_list.size() != 3 || !isType(command.sub_list[2])) {
+                is_valid = false;
+            } else {
+                spec->global_variable_map[command.sub_list[1].value] = util::string2Type(command.sub_list[2].value);
+            }
+        } else if (command.sub_list[0].isSymbol("constraint")) {
+            auto* example = loadExample(command, function_name, spec->param_list.size());
+            if (example == nullptr) is_valid = false;
+            else spec->example_space.push_back(example);
+        }
+    }
+    if (!is_valid) {
+        delete spec;
+        return nullptr;
+    }
+    spec->initPBE();
+    return spec;
+}
@@ -0,0 +1,32 @@
+#ifndef L2S_SYGUS_PARSER_H
+#define L2S_SYGUS_PARSER_H
+
+#include "specification.h"
+
+namespace parser {
+    // A node of an s-expression. Literals are typed as in SyGuS: "Int", "String" and "Bool". The content of a string
+    // literal is kept as it is in the file, without unescaping.
+    struct SExp {
+        enum Kind {LIST, SYMBOL, INT, STRING, BOOL};
+        Kind kind;
+        std::string value;
+        int int_value = 0;
+        std::vector<SExp> sub_list;
+        SExp(Kind _kind): kind(_kind) {}
+        bool isSymbol(const std::string& name) const {return kind == SYMBOL && value == name;}
+        bool isLiteral() const {return kind == INT || kind == STRING || kind == BOOL;}
+    };
+
+    // Parse all top-level s-expressions in a SyGuS file into "result". Comments starting with ';' are skipped. Return
+    // false if the file is malformed, e.g., a list is not closed or an integer literal does not fit into "int".
+    extern bool parseSExpFile(const std::string& file_name, std::vector<SExp>& result);
+
+    // Build a PBE specification from a SyGuS file in process. The grammar is normalized in the same way as the python
+    // parser in "parser/python": the start symbol is replaced by the non-terminal it expands to, integer constants
+    // other than -1, 0 and 1 are removed, and duplicated rules are merged.
+    // The result is nullptr if the file is malformed or is not a PBE problem on literal examples, e.g., a constraint
+    // uses a declared variable or an auxiliary function. Such files are left to the python parser.
+    extern Specification* loadSyGuSSpecification(const std::string& file_name);
+}
+
+#endif //L2S_SYGUS_PARSER_H
@@ -0,0 +1,48 @@
+#include "arena.h"
+
+#include <algorithm>
+#include <cstdlib>
+
+void* Arena::allocate(size_t size, size_t align) {
+    if (!slab_list.empty()) {
+        Slab& slab = slab_list.back();
+        size_t start = (slab.used + align - 1) / align * align;
+        if (start + size <= slab.capacity) {
+            slab.used = start + size;
+            ++slab.object_num;
+            return slab.buffer + start;
+        }
+    }
+    // Objects larger than a slab get a slab of their own.
+    size_t capacity = std::max(size, slab_size);
+    char* buffer = static_cast<char*>(std::malloc(capacity));
+    if (buffer == nullptr) throw std::bad_alloc();
+    slab_list.emplace_back(buffer, capacity);
+    Slab& slab = slab_list.back();
+    slab.used = size;
+    slab.object_num = 1;
+    return buffer;
+}
+
+void Arena::release() {
+    for (auto it = destroy_list.rbegin(); it != destroy_list.rend(); ++it) {
+        it->destroyer(it->object);
+    }
+    destroy_list.clear();
+    for (auto& slab: slab_list) {
+        std::free(slab.buffer);
+    }
+    slab_list.clear();
+}
+
+size_t Arena::getAllocatedBytes() const {
+    size_t result = 0;
+    for (auto& slab: slab_list) result += slab.used;
+    return result;
+}
+
+int Arena::getObjectNum() const {
+    int result = 0;
+    for (auto& slab: slab_list) result += slab.object_num;
+    return result;
+}
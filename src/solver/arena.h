@@ -0,0 +1,69 @@
+#ifndef L2S_ARENA_H
+#define L2S_ARENA_H
+
+#include <vector>
+#include <new>
+#include <cstddef>
+#include <utility>
+#include <type_traits>
+
+// A region allocator. Objects are placed one after another into large slabs and are never freed individually:
+// "release" destroys all of them at once and returns the slabs.
+// Objects with non-trivial destructors are recorded, and their destructors (or a customized destroyer) are
+// invoked in the reverse order of creation when the arena is released.
+class Arena {
+public:
+    typedef void (*Destroyer)(void*);
+
+    struct Slab {
+        char* buffer;
+        size_t capacity, used;
+        int object_num;
+        Slab(char* _buffer, size_t _capacity): buffer(_buffer), capacity(_capacity), used(0), object_num(0) {}
+    };
+
+private:
+    struct DestroyInfo {
+        void* object;
+        Destroyer destroyer;
+        DestroyInfo(void* _object, Destroyer _destroyer): object(_object), destroyer(_destroyer) {}
+    };
+    size_t slab_size;
+    std::vector<Slab> slab_list;
+    std::vector<DestroyInfo> destroy_list;
+
+    void* allocate(size_t size, size_t align);
+
+    template<class T>
+    static void destroyObject(void* object) {
+        static_cast<T*>(object)->~T();
+    }
+
+public:
+    Arena(size_t _slab_size = (1 << 20)): slab_size(_slab_size) {}
+    Arena(const Arena&) = delete;
+    Arena& operator = (const Arena&) = delete;
+    ~Arena() {release();}
+
+    template<class T, class... Args>
+    T* create(Args&&... args) {
+        return createWithDestroyer<T>(std::is_trivially_destructible<T>::value ? nullptr : &destroyObject<T>,
+                std::forward<Args>(args)...);
+    }
+
+    // Create an object whose destruction is handled by "destroyer" instead of its destructor.
+    template<class T, class... Args>
+    T* createWithDestroyer(Destroyer destroyer, Args&&... args) {
+        T* object = new (allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+        if (destroyer != nullptr) destroy_list.emplace_back(object, destroyer);
+        return object;
+    }
+
+    void release();
+
+    const std::vector<Slab>& getSlabList() const {return slab_list;}
+    size_t getAllocatedBytes() const;
+    int getObjectNum() const;
+};
+
+#endif //L2S_ARENA_H
@@ -38,9 +38,9 @@ std::vector<Program*> TopDownContextMaintainer::getTrace(const PathInfo &path) {
 }
 
 std::string TopDownContextMaintainer::encodeConstant(const Data& data) {
-    if (global::spec_type != S_PBE || data.getType() != TSTRING)
+    if (global::context->spec_type != S_PBE || data.getType() != TSTRING)
         return "Constant@" + util::type2String(data.getType());
-    return util::getStringConstType(data.getString());
+    return util::getStringConstType(data);
 }
 
 std::string TopDownContextMaintainer::semantics2String(Semantics *semantics) {
@@ -59,10 +59,10 @@ TopDownContext* TopDownContextMaintainer::getAbstractedContext(const PathInfo &p
     auto trace = getTrace(path);
     std::vector<std::string> result;
     int start_pos = 0;
-    if (trace.size() < global::KContextDepth) {
-        for (int i = trace.size(); i < global::KContextDepth; ++i) result.emplace_back("None");
+    if (trace.size() < global::context->KContextDepth) {
+        for (int i = trace.size(); i < global::context->KContextDepth; ++i) result.emplace_back("None");
     } else {
-        start_pos = trace.size() - global::KContextDepth;
+        start_pos = trace.size() - global::context->KContextDepth;
     }
     for (int i = start_pos; i < trace.size(); ++i) {
         Program* current_node = trace[i];
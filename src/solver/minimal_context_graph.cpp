@@ -2,18 +2,19 @@
 #include "semantics_factory.h"
 
 #include <queue>
+#include <unordered_set>
 #include <cmath>
 #include <config.h>
 #include <iostream>
 
 namespace {
-    std::map<std::string, Semantics*> temp_semantics_map = {
+    const std::map<std::string, Semantics*> temp_semantics_map = {
             {"Param@Int", new ParamSemantics(0, TINT)},
             {"Param@Bool", new ParamSemantics(0, TBOOL)},
             {"Param@String", new ParamSemantics(0, TSTRING)},
-            {"Constant@Int", new ConstSemantics(Data(new IntValue(0)))},
-            {"Constant@Bool", new ConstSemantics(Data(new BoolValue(false)))},
-            {"Constant@String", new ConstSemantics(Data(new StringValue("")))}
+            {"Constant@Int", new ConstSemantics(Data(0))},
+            {"Constant@Bool", new ConstSemantics(Data(false))},
+            {"Constant@String", new ConstSemantics(Data(""))}
     };
 
     bool checkFinished(std::string name) {
@@ -21,7 +22,7 @@ namespace {
     }
 
     Semantics* getTempSemantics(std::string name) {
-        if (checkFinished(name)) return temp_semantics_map[name];
+        if (checkFinished(name)) return temp_semantics_map.at(name);
         return string2Semantics(name);
     }
 
@@ -44,8 +45,8 @@ bool MinimalContextGraph::matchRuleWithName(std::string name, Rule* rule) {
     if (name.find("Constant@") != std::string::npos) {
         auto* semantics = dynamic_cast<ConstSemantics*>(rule->semantics);
         if (semantics == nullptr) return false;
-        if (global::spec_type == S_PBE && semantics->oup_type == TSTRING) {
-            return name == util::getStringConstType(semantics->value.getString());
+        if (global::context->spec_type == S_PBE && semantics->oup_type == TSTRING) {
+            return name == util::getStringConstType(semantics->value);
         }
         return semantics != nullptr && name.find(util::type2String(semantics->oup_type)) != std::string::npos;
     }
@@ -53,11 +54,37 @@ bool MinimalContextGraph::matchRuleWithName(std::string name, Rule* rule) {
     return rule->semantics->name == semantics->name;
 }
 
-bool MinimalContextGraph::searchForValue(ContextInfo* context_info, Rule* rule, double& value) {
-    for (auto& rule_info: (*context_info)) {
-        std::string name = rule_info.first;
+std::string MinimalContextGraph::getGrammarKey(NonTerminal *start_symbol) {
+    std::string result;
+    std::unordered_set<NonTerminal*> visited = {start_symbol};
+    std::queue<NonTerminal*> Q;
+    Q.push(start_symbol);
+    while (!Q.empty()) {
+        auto* symbol = Q.front(); Q.pop();
+        result += symbol->name + ":" + util::type2String(symbol->type) + "{";
+        for (auto* rule: symbol->rule_list) {
+            result += rule->semantics->name;
+            auto* semantics = dynamic_cast<ConstSemantics*>(rule->semantics);
+            if (semantics != nullptr && global::context->spec_type == S_PBE && semantics->oup_type == TSTRING) {
+                result += "@" + util::getStringConstType(semantics->value);
+            }
+            result += "(";
+            for (auto* param: rule->param_list) {
+                result += param->name + ",";
+                if (visited.insert(param).second) Q.push(param);
+            }
+            result += ");";
+        }
+        result += "}";
+    }
+    return result;
+}
+
+bool MinimalContextGraph::searchForValue(const ContextInfo& context_info, Rule* rule, double& value) {
+    for (int i = 0; i < context_info.size(); ++i) {
+        std::string name(context_info.getName(i));
         if (matchRuleWithName(name, rule)) {
-            value = rule_info.second;
+            value = context_info.getProbability(i);
             return true;
         }
     }
@@ -94,31 +121,31 @@ void MinimalContextGraph::buildGraph() {
         maintainer->partial_program = current_program;
         Context* abstracted_context = maintainer->getAbstractedContext(current_path);
 
-        auto* context_info = info_map->getContextInfo(abstracted_context);
+        auto context_info = info_map->getContextInfo(abstracted_context);
         auto* symbol = node_list[current_pos].symbol;
         double sum = 0.0;
         for (auto* rule: symbol->rule_list) {
             double value = 0;
-            if (searchForValue(context_info, rule, value)) sum += std::max(value, config::KDefaultP);
-            else sum += config::KDefaultP;
+            if (searchForValue(context_info, rule, value)) sum += std::max(value, global::context->KDefaultP);
+            else sum += global::context->KDefaultP;
         }
-        if (global::isMatrix) sum = 1.0;
+        if (global::context->isMatrix) sum = 1.0;
         for (auto* rule: symbol->rule_list) {
             double value = 0;
             if (!searchForValue(context_info, rule, value)) {
-                value = config::KDefaultP;
+                value = global::context->KDefaultP;
             }
             /*if (dynamic_cast<ConstSemantics*>(rule->semantics)) {
                 std::cout << "now " << abstracted_context->encodeContext() << std::endl;
                 std::cout << "const " << value << std::endl;
-                for (auto info: *context_info) {
-                    std::cout << info.first << " " << info.second << std::endl;
+                for (int i = 0; i < context_info.size(); ++i) {
+                    std::cout << context_info.getName(i) << " " << context_info.getProbability(i) << std::endl;
                 }
             }*/
             if (value == 0) {
                 continue;
             }
-            value = std::max(value, config::KDefaultP);
+            value = std::max(value, global::context->KDefaultP);
             value = std::min(0.0, std::log(value / sum));
             Semantics* semantics = rule->semantics;
             maintainer->partial_program = new Program(current_program);
@@ -208,4 +235,11 @@ void MinimalContextGraph::printUpperBound() {
         }
         puts("==================");*/
     }
-}
\ No newline at end of file
+}
+
+MinimalContextGraph::~MinimalContextGraph() {
+    for (auto& node: minimal_context_list) {
+        for (auto* edge: node.edge_list) delete edge;
+        delete node.minimal_context;
+    }
+}
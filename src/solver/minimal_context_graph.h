@@ -36,9 +36,14 @@ public:
     void printUpperBound();
 
     static bool matchRuleWithName(std::string name, Rule* rule);
-    static bool searchForValue(ContextInfo* context_info, Rule* rule, double& value);
+    static bool searchForValue(const ContextInfo& context_info, Rule* rule, double& value);
+    // A key of everything the graph depends on other than the model: the grammar expanded from "start_symbol" and
+    // the abstracted names of its string constants. Graphs built with the same key and the same model are identical.
+    static std::string getGrammarKey(NonTerminal* start_symbol);
 
     MinimalContextGraph(NonTerminal* _start_symbol, ContextMaintainer* _maintainer, ContextInfoMap* _info_map);
+    // Edges and contexts belong to the graph. The maintainer and the model are not owned by the graph.
+    ~MinimalContextGraph();
 };
 
 
@@ -1,7 +1,9 @@
 #include "solver.h"
+#include "string_relation.h"
 
 #include <iostream>
 #include <cmath>
+#include <algorithm>
 #include <config.h>
 #include <glog/logging.h>
 
@@ -16,16 +18,112 @@ namespace {
         return result;
     }
 
-    ParamInfo* example2ParamInfo(Example* example) {
-        return new ParamInfo(example->inp);
+    // Whether the current thread is running a task of the parallel search. Nested searches inside a task are
+    // sequential.
+    thread_local bool is_in_parallel_task = false;
+
+    // The candidates of the divide-and-conquer mode, evaluated on all examples.
+    struct DivisionInfo {
+        // Terms in the order of the greedy cover: each term covers the most examples not covered by previous ones.
+        std::vector<SharedProgram*> term_list, guard_list;
+        std::vector<std::vector<bool>> term_cover, guard_value;
+        std::vector<double> guard_p;
+        // The first term covering each example.
+        std::vector<int> label_list;
+    };
+
+    double getEntropy(const std::vector<int>& id_list, const DivisionInfo& info) {
+        std::unordered_map<int, int> label_num;
+        for (int id: id_list) label_num[info.label_list[id]]++;
+        double result = 0;
+        for (auto& label_info: label_num) {
+            double p = label_info.second * 1.0 / id_list.size();
+            result -= p * std::log(p);
+        }
+        return result;
+    }
+
+    // Learn a decision tree over the examples in "id_list" by ID3: a leaf is a term covering all examples, and an inner
+    // node is the guard with the least entropy of labels after the split. Ties are broken by the probability of guards.
+    SharedProgram* learnDecisionTree(const std::vector<int>& id_list, const DivisionInfo& info, Semantics* ite,
+            SharedProgramPool& program_pool) {
+        for (int i = 0; i < info.term_list.size(); ++i) {
+            bool is_cover = true;
+            for (int id: id_list) {
+                if (!info.term_cover[i][id]) {
+                    is_cover = false;
+                    break;
+                }
+            }
+            if (is_cover) return info.term_list[i];
+        }
+        int best_guard = -1;
+        double best_entropy = 1e100;
+        std::vector<int> best_true_list, best_false_list;
+        for (int i = 0; i < info.guard_list.size(); ++i) {
+            std::vector<int> true_list, false_list;
+            for (int id: id_list) {
+                (info.guard_value[i][id] ? true_list : false_list).push_back(id);
+            }
+            if (true_list.empty() || false_list.empty()) continue;
+            double entropy = (getEntropy(true_list, info) * true_list.size() +
+                    getEntropy(false_list, info) * false_list.size()) / id_list.size();
+            if (entropy < best_entropy - 1e-8 ||
+                    (entropy < best_entropy + 1e-8 && info.guard_p[i] > info.guard_p[best_guard])) {
+                best_guard = i;
+                best_entropy = entropy;
+                best_true_list = true_list;
+                best_false_list = false_list;
+            }
+        }
+        if (best_guard == -1) return nullptr;
+        auto* true_program = learnDecisionTree(best_true_list, info, ite, program_pool);
+        if (true_program == nullptr) return nullptr;
+        auto* false_program = learnDecisionTree(best_false_list, info, ite, program_pool);
+        if (false_program == nullptr) return nullptr;
+        return program_pool.getProgram(ite, {info.guard_list[best_guard], true_program, false_program});
     }
 
     std::string encodeFeature(const int& state, const StateValue& oup) {
         return std::to_string(state) + encodeStateValue(oup);
     }
+
+    void appendDataList(StateKey& key, const DataList& data_list) {
+        key.push(data_list.size());
+        for (auto& data: data_list) {
+            key.push(global::context->data_pool->getId(data));
+        }
+    }
+
+    StateKey encodeKey(int state, const StateValue& value) {
+        StateKey key;
+        key.push(state);
+        for (auto& data_list: value) {
+            appendDataList(key, data_list);
+        }
+        return key;
+    }
+
+    // Append the ids of all DataLists in "suffix" (i.e., all ids except the state) to "key".
+    void appendKey(StateKey& key, const StateKey& suffix) {
+        for (int i = 1; i < suffix.ids.size(); ++i) {
+            key.push(suffix.ids[i]);
+        }
+    }
+
+    // Split the key of a combined node into the key of its prefix examples and the key of its last example.
+    void splitKey(const StateKey& key, StateKey& l, StateKey& r) {
+        int last = 1;
+        for (int pos = 1; pos < key.ids.size(); pos += key.ids[pos] + 1) {
+            last = pos;
+        }
+        l.push(key.ids[0]); r.push(key.ids[0]);
+        for (int i = 1; i < last; ++i) l.push(key.ids[i]);
+        for (int i = last; i < key.ids.size(); ++i) r.push(key.ids[i]);
+    }
 }
 
-double SynthesisTask::calculateProbability(int state, Program* program) {
+double SynthesisTask::calculateProbability(int state, SharedProgram* program) {
     double result = 0.0;
     MinimalContextGraph::Edge* current_edge = nullptr;
     auto& node = graph->minimal_context_list[state];
@@ -46,16 +144,26 @@ double SynthesisTask::calculateProbability(int state, Program* program) {
 
 void SynthesisTask::verifyResult(int start_state, VSANode *result) {
     ContextMaintainer* maintainer = graph->maintainer;
-    maintainer->partial_program = new Program(result->best_program);
+    SharedProgram* program = result->best_program;
+    maintainer->partial_program = program->toProgram();
     PathInfo path = {};
-    double probability = calculateProbability(start_state, result->best_program);
+    double probability = calculateProbability(start_state, program);
     assert(std::fabs(probability - result->p) < 1e-6);
     maintainer->clear();
 }
 
 void SynthesisTask::addNewExample(Example *example) {
     example_list.push_back(example);
-    param_info_list.push_back(example2ParamInfo(example));
+    if (global::context->spec_type == S_PBE) {
+        // Each example has its own copy of the global info, so that witness functions of different examples can run
+        // at the same time.
+        auto* info = arena.create<StringInfo>(*global::context->string_info);
+        info->setInp(example->inp);
+        if (!global::context->isMatrix) info->string_relation = std::make_shared<const StringRelation>(info);
+        param_info_list.push_back(info);
+    } else {
+        param_info_list.push_back(arena.create<ParamInfo>(example->inp));
+    }
     single_node_map.emplace_back();
 }
 
@@ -81,21 +189,30 @@ Program* SynthesisTask::getBestProgramWithoutOup(int state) {
 }
 
 void SynthesisTask::buildEdge(VSANode *node, int example_id) {
-    node->is_build_edge = true;
+    std::lock_guard<std::mutex> build_guard(node->build_lock);
+    if (node->is_build_edge) return;
     if (example_id <= 0) {
-        auto& graph_node = graph->minimal_context_list[node->state];
-        for (auto* graph_edge: graph_node.edge_list) {
-            GlobalInfo* info = nullptr;
-            if (global::spec_type == S_PBE) {
-                global::string_info->setInp(example_list[-example_id]->inp);
-                info = global::string_info;
-            } else info = param_info_list[-example_id];
-            auto result = graph_edge->rule->semantics->witnessFunction(node->value[0], info);
+        auto& graph_edge_list = graph->minimal_context_list[node->state].edge_list;
+        GlobalInfo* info = param_info_list[-example_id];
+        // Witness functions of different graph edges are independent, and thus they can be evaluated in parallel.
+        // The results are merged in the order of the graph edges, so the VSA is the same as in the sequential mode.
+        std::vector<WitnessList> result_list(graph_edge_list.size());
+        auto witness = [&](int i) {
+            result_list[i] = graph_edge_list[i]->rule->semantics->witnessFunction(node->value[0], info);
+        };
+        if (global::thread_pool != nullptr) {
+            global::thread_pool->parallelFor(graph_edge_list.size(), witness);
+        } else {
+            for (int i = 0; i < graph_edge_list.size(); ++i) witness(i);
+        }
+        std::lock_guard<std::recursive_mutex> vsa_guard(vsa_lock);
+        for (int edge_id = 0; edge_id < graph_edge_list.size(); ++edge_id) {
+            auto* graph_edge = graph_edge_list[edge_id];
+            auto& result = result_list[edge_id];
 #ifdef DEBUG
             checkWitness(graph_edge->rule->semantics, result, node->value[0], info);
 #endif
             for (auto& result_term: result) {
-                std::vector<VSANode*> sub_node_list;
 #ifdef DEBUG
                 assert(result_term.size() == graph_edge->rule->param_list.size());
 #endif
@@ -103,13 +220,14 @@ void SynthesisTask::buildEdge(VSANode *node, int example_id) {
                 for (int i = 0; i < result_term.size(); ++i) {
                     sub_node.push_back(initNode(graph_edge->v[i], {result_term[i]}, example_id));
                 }
-                node->edge_list.push_back(new VSAEdge(sub_node, graph_edge->rule->semantics, graph_edge->w));
+                node->edge_list.push_back(arena.create<VSAEdge>(sub_node, graph_edge->rule->semantics, graph_edge->w));
             }
         }
     } else {
         VSANode *l = node->l, *r = node->r;
         if (!l->is_build_edge) buildEdge(l, example_id - 1);
         if (!r->is_build_edge) buildEdge(r, -example_id);
+        std::lock_guard<std::recursive_mutex> vsa_guard(vsa_lock);
         std::unordered_map<std::string, std::pair<std::vector<VSAEdge*>, std::vector<VSAEdge*>>> edge_info;
         for (auto* edge: l->edge_list) {
             edge_info[edge->semantics->name].first.push_back(edge);
@@ -130,7 +248,9 @@ void SynthesisTask::buildEdge(VSANode *node, int example_id) {
 #endif
                         StateValue value = l_edge->v[i]->value;
                         value.push_back(r_edge->v[i]->value[0]);
-                        v.push_back(initNode(l_edge->v[i]->state, value, example_id));
+                        StateKey key = l_edge->v[i]->key;
+                        appendKey(key, r_edge->v[i]->key);
+                        v.push_back(initNode(key, value, example_id));
                     }
                     bool is_invalid = false;
                     for (auto* sub_node: v) {
@@ -140,12 +260,13 @@ void SynthesisTask::buildEdge(VSANode *node, int example_id) {
                         }
                     }
                     if (!is_invalid) {
-                        node->edge_list.push_back(new VSAEdge(v, l_edge->semantics, l_edge->rule_w));
+                        node->edge_list.push_back(arena.create<VSAEdge>(v, l_edge->semantics, l_edge->rule_w));
                     }
                 }
             }
         }
     }
+    node->is_build_edge = true;
 }
 
 void SynthesisTask::VSAEdge::print() {
@@ -160,102 +281,248 @@ void SynthesisTask::VSANode::print() {
 
 #define TRIVIAL_BOUND(node) (graph->minimal_context_list[node->state].upper_bound)
 
+namespace {
+    bool isFinished(SynthesisTask::VSAEdge* edge) {
+        for (auto* sub_node: edge->v) {
+            if (sub_node->best_program == nullptr) return false;
+        }
+        return true;
+    }
+
+    void raiseLimit(std::atomic<double>& shared_limit, double value) {
+        double current = shared_limit.load();
+        while (current < value && !shared_limit.compare_exchange_weak(current, value));
+    }
+}
+
+// Explore a single candidate edge of a node as a task of the parallel search. "shared_limit" is the lower bound
+// shared by all tasks of the node: It is raised as soon as a task finishes its edge, and every task re-reads it
+// before exploring a sub-node, so that a better program found by one task immediately prunes the others.
+void SynthesisTask::searchEdgeInParallel(VSAEdge *edge, int example_id, std::atomic<double> &shared_limit) {
+    while (!isCancelled()) {
+        double limit = shared_limit.load();
+        if (edge->updateW() <= limit) return;
+        int unfinished_num = 0;
+        for (auto* sub_node: edge->v) {
+            if (sub_node->best_program == nullptr) ++unfinished_num;
+        }
+        if (unfinished_num == 0) {
+            raiseLimit(shared_limit, edge->w);
+            return;
+        }
+        double remain = (limit - edge->w) / unfinished_num;
+        std::vector<double> remain_list;
+        for (auto* sub_node: edge->v) {
+            remain_list.push_back(sub_node->p);
+        }
+        for (int i = 0; i < remain_list.size(); ++i) {
+            VSANode* sub_node = edge->v[i];
+            if (sub_node->best_program == nullptr && getBestProgramWithOup(sub_node, example_id, remain_list[i] + remain)) {
+                break;
+            }
+        }
+    }
+}
+
+// Return the largest current weight of the edges in the frontier of "node". Entries of the heap are refreshed lazily:
+// weights only decrease, so once the recorded weight of the top entry is still current, it is the maximum.
+double SynthesisTask::getFrontierTop(VSANode *node) {
+    auto& heap = node->frontier;
+    while (!heap.empty()) {
+        double w = node->edge_list[heap.front().second]->updateW();
+        if (w >= heap.front().first) return w;
+        std::pop_heap(heap.begin(), heap.end());
+        heap.back().first = w;
+        std::push_heap(heap.begin(), heap.end());
+    }
+    return -1e100;
+}
+
+// Take the frontier of "node" for the current search. Fail if the node has no up-to-date frontier or another
+// search is using it.
+bool SynthesisTask::acquireFrontier(VSANode *node) {
+    if (!node->has_frontier || !node->is_frontier_busy.compareAndSet(false, true)) return false;
+    if (node->frontier_epoch == frontier_epoch) return true;
+    node->is_frontier_busy = false;
+    return false;
+}
+
+// Recompute the upperbound "p" of a node from its frontier. The caller must hold "is_frontier_busy".
+double SynthesisTask::updatePFromFrontier(VSANode *node) {
+    double new_p = getFrontierTop(node);
+    if (node->l) new_p = std::min(new_p, std::min<double>(node->l->p, node->r->p));
+    node->p = new_p;
+    return new_p;
+}
+
+void SynthesisTask::recordFrontier(VSANode *node, const std::vector<int> &edge_id_list) {
+    auto& heap = node->frontier;
+    for (int edge_id: edge_id_list) {
+        heap.emplace_back(node->edge_list[edge_id]->updateW(), edge_id);
+        std::push_heap(heap.begin(), heap.end());
+    }
+}
+
 bool SynthesisTask::getBestProgramWithOup(VSANode* node, int example_id, double limit) {
     if (node->best_program != nullptr) return true;
+    if (isCancelled()) return false;
     if (node->p < limit) return false;
     if (node->l != nullptr) {
         if (!getBestProgramWithOup(node->l, example_id - 1, limit) || !getBestProgramWithOup(node->r, -example_id, limit)) {
-            node->updateP();
+            if (acquireFrontier(node)) {
+                updatePFromFrontier(node);
+                node->is_frontier_busy = false;
+            } else node->updateP();
             return false;
         }
-        auto *candidate = node->l->best_program;
-        if (util::checkInOupList(candidate->run(example_list[example_id]->inp), node->value[example_id])) {
-            node->best_program = candidate;
-            node->p = node->l->p;
+        SharedProgram* candidate = node->l->best_program;
+        if (util::checkInOupList(candidate->run(param_info_list[example_id], example_id, &example_cache), node->value[example_id])) {
+            // Raising "p" may raise the weights of edges recorded in frontiers, so all frontiers become stale.
+            if (node->l->p > node->p) ++frontier_epoch;
+            node->p = double(node->l->p);
+            node->best_program.compareAndSet(nullptr, candidate);
             return true;
         }
     }
     if (!node->is_build_edge) {
         buildEdge(node, example_id);
     }
-    if (node->updateP() < limit) return false;
+    ++expand_num;
+    // If a previous search on this node has failed, resume from its frontier: only edges whose recorded weight
+    // reaches the current limit are considered. The frontier is skipped if another thread is using it.
+    bool is_resumed = acquireFrontier(node);
+    std::vector<int> resumed_list;
+    if (is_resumed) {
+        ++resume_num;
+        if (updatePFromFrontier(node) < limit) {
+            node->is_frontier_busy = false;
+            return false;
+        }
+        auto& heap = node->frontier;
+        while (!heap.empty() && heap.front().first >= limit) {
+            resumed_list.push_back(heap.front().second);
+            std::pop_heap(heap.begin(), heap.end());
+            heap.pop_back();
+        }
+        std::sort(resumed_list.begin(), resumed_list.end());
+    } else if (node->updateP() < limit) return false;
     std::vector<VSAEdge*> possible_edge;
     double _limit = limit;
-    for (auto* edge: node->edge_list) {
+    auto add_candidate = [&](VSAEdge* edge) {
         if (edge->w >= limit) {
-            bool is_finished = true;
-            for (auto* sub_node: edge->v) {
-                if (sub_node->best_program == nullptr) {
-                    is_finished = false;
-                    break;
-                }
-            }
-            if (is_finished) {
-                limit = std::max(edge->w, limit);
+            if (isFinished(edge)) {
+                limit = std::max<double>(edge->w, limit);
             } else {
                 possible_edge.push_back(edge);
             }
         }
+    };
+    if (is_resumed) {
+        for (int edge_id: resumed_list) {
+            node->edge_list[edge_id]->updateW();
+            add_candidate(node->edge_list[edge_id]);
+        }
+        scan_edge_num += resumed_list.size();
+    } else {
+        for (auto* edge: node->edge_list) {
+            add_candidate(edge);
+        }
+        scan_edge_num += node->edge_list.size();
     }
-    while (true) {
-        VSAEdge* best_edge = nullptr;
-        double best_remain = 0;
-        for (auto *edge: possible_edge) {
-            if (edge->w <= limit) continue;
+    if (is_parallel_search && global::thread_pool != nullptr && !is_in_parallel_task && possible_edge.size() > 1) {
+        // Each candidate edge becomes a task. Tasks are submitted in the order in which the sequential search would
+        // pick the edges, i.e., the edge with the most slack per unfinished sub-node comes first.
+        std::vector<std::pair<double, VSAEdge*>> task_list;
+        for (auto* edge: possible_edge) {
+            // An edge leading back to the node itself can never be better than the node.
+            if (std::find(edge->v.begin(), edge->v.end(), node) != edge->v.end()) continue;
             int unfinished_num = 0;
-            for (auto *sub_node: edge->v) {
+            for (auto* sub_node: edge->v) {
                 if (sub_node->best_program == nullptr) ++unfinished_num;
             }
-            if (unfinished_num == 0) continue;
-            if ((limit - edge->w) / unfinished_num < best_remain) {
-                best_remain = (limit - edge->w) / unfinished_num;
-                best_edge = edge;
-            }
-        }
-        if (best_edge == nullptr) break;
-        std::vector<double> remain_list;
-        for (auto* sub_node: best_edge->v) {
-            remain_list.push_back(sub_node->p);
+            task_list.emplace_back((limit - edge->w) / std::max(unfinished_num, 1), edge);
         }
-        for (int i = 0; i < remain_list.size(); ++i) {
-            VSANode* sub_node = best_edge->v[i];
-            if (sub_node->best_program == nullptr && getBestProgramWithOup(sub_node, example_id,remain_list[i] + best_remain)) {
-                break;
+        std::stable_sort(task_list.begin(), task_list.end(),
+                [](const std::pair<double, VSAEdge*>& x, const std::pair<double, VSAEdge*>& y) {return x.first < y.first;});
+        std::atomic<double> shared_limit(limit);
+        global::thread_pool->parallelFor(task_list.size(), [&](int i) {
+            is_in_parallel_task = true;
+            searchEdgeInParallel(task_list[i].second, example_id, shared_limit);
+            is_in_parallel_task = false;
+        });
+        limit = shared_limit.load();
+    } else {
+        while (true) {
+            VSAEdge* best_edge = nullptr;
+            double best_remain = 0;
+            for (auto *edge: possible_edge) {
+                if (edge->w <= limit) continue;
+                int unfinished_num = 0;
+                for (auto *sub_node: edge->v) {
+                    if (sub_node->best_program == nullptr) ++unfinished_num;
+                }
+                if (unfinished_num == 0) continue;
+                if ((limit - edge->w) / unfinished_num < best_remain) {
+                    best_remain = (limit - edge->w) / unfinished_num;
+                    best_edge = edge;
+                }
             }
-        }
-        int now = 0;
-        node->p = limit;
-        for (auto* edge: possible_edge) {
-            if (edge->updateW() < limit) continue;
-            bool is_finished = true;
-            for (auto* sub_node: edge->v) {
-                if (sub_node->best_program == nullptr) {
-                    is_finished = false;
+            // A cancelled search does not lower the bounds of sub-nodes, so the loop must stop here.
+            if (best_edge == nullptr || isCancelled()) break;
+            std::vector<double> remain_list;
+            for (auto* sub_node: best_edge->v) {
+                remain_list.push_back(sub_node->p);
+            }
+            for (int i = 0; i < remain_list.size(); ++i) {
+                VSANode* sub_node = best_edge->v[i];
+                if (sub_node->best_program == nullptr && getBestProgramWithOup(sub_node, example_id,remain_list[i] + best_remain)) {
                     break;
                 }
             }
-            if (is_finished) {
-                limit = std::max(limit, edge->w);
-            } else {
-                possible_edge[now++] = edge;
+            int now = 0;
+            // The new bound is computed locally and stored once, since other threads may read it at any time.
+            double new_p = limit;
+            for (auto* edge: possible_edge) {
+                if (edge->updateW(node, new_p) < limit) continue;
+                if (isFinished(edge)) {
+                    limit = std::max<double>(limit, edge->w);
+                } else {
+                    possible_edge[now++] = edge;
+                }
+                new_p = std::max(new_p, edge->updateW(node, new_p));
             }
-            node->p = std::max(node->p, edge->updateW());
+            if (node->l) new_p = std::min(new_p, std::min<double>(node->l->p, node->r->p));
+            node->p = new_p;
+            possible_edge.resize(now);
         }
-        if (node->l) node->p = std::min(node->p, std::min(node->l->p, node->r->p));
-        possible_edge.resize(now);
     }
-    node->updateP();
     VSAEdge* best_edge = nullptr;
-    for (auto* edge: node->edge_list) {
-        if (fabs(edge->w - limit) > 1e-8) continue;
-        bool is_finished = true;
-        for (auto* node: edge->v) {
-            if (node->best_program == nullptr) {
-                is_finished = false;
-                break;
+    if (is_resumed) {
+        recordFrontier(node, resumed_list);
+        updatePFromFrontier(node);
+        for (int edge_id: resumed_list) {
+            auto* edge = node->edge_list[edge_id];
+            if (fabs(edge->w - limit) > 1e-8) continue;
+            if (isFinished(edge)) {best_edge = edge; break;}
+        }
+        node->is_frontier_busy = false;
+    } else {
+        node->updateP();
+        for (auto* edge: node->edge_list) {
+            if (fabs(edge->w - limit) > 1e-8) continue;
+            if (isFinished(edge)) {best_edge = edge; break;}
+        }
+        if (best_edge == nullptr && node->is_frontier_busy.compareAndSet(false, true)) {
+            if (!node->has_frontier || node->frontier_epoch != frontier_epoch) {
+                std::vector<int> edge_id_list(node->edge_list.size());
+                for (int i = 0; i < edge_id_list.size(); ++i) edge_id_list[i] = i;
+                node->frontier.clear();
+                node->frontier_epoch = frontier_epoch;
+                recordFrontier(node, edge_id_list);
+                node->has_frontier = true;
             }
+            node->is_frontier_busy = false;
         }
-        if (is_finished) {best_edge = edge; break;}
     }
 #ifdef DEBUG
     if (fabs(limit - _limit) > 1e-8) {
@@ -267,11 +534,19 @@ bool SynthesisTask::getBestProgramWithOup(VSANode* node, int example_id, double
     }
 #endif
     if (best_edge != nullptr) {
-        std::vector<Program*> sub_program;
+        std::vector<SharedProgram*> sub_program;
         for (auto* sub_node: best_edge->v) {
-            sub_program.push_back(new Program(sub_node->best_program));
+            sub_program.push_back(sub_node->best_program);
+        }
+        auto* program = program_pool.getProgram(best_edge->semantics, sub_program);
+        // Another thread may have finished this node in the meantime. Both programs are optimal, keep the first one.
+        node->best_program.compareAndSet(nullptr, program);
+        // A solved node is never searched again, so its frontier can be dropped.
+        if (node->has_frontier && node->is_frontier_busy.compareAndSet(false, true)) {
+            node->has_frontier = false;
+            std::vector<std::pair<double, int>>().swap(node->frontier);
+            node->is_frontier_busy = false;
         }
-        node->best_program = new Program(sub_program, best_edge->semantics);
 
         verifyExampleResult(node, example_id);
         return true;
@@ -292,10 +567,11 @@ void SynthesisTask::verifyExampleResult(SynthesisTask::VSANode *node, int exampl
         r = example_id;
     }
     for (int i = l; i <= r; ++i) {
-        auto oup = node->best_program->run(example_list[i]->inp);
+        SharedProgram* program = node->best_program;
+        auto oup = program->run(param_info_list[i], i, &example_cache);
         if (!util::checkInOupList(oup, node->value[i - l])) {
             std::cout << graph->minimal_context_list[node->state].minimal_context->encodeContext() << " " << graph->minimal_context_list[node->state].symbol->name << " " << encodeFeature(node->state, node->value) << std::endl;
-            node->best_program->print();
+            program->print();
             std::cout << util::dataList2String(node->value[i - l]) << " " << example_list[i]->toString() << std::endl;
             std::cout << oup.toString() << " " << example_id << std::endl;
 
@@ -305,38 +581,197 @@ void SynthesisTask::verifyExampleResult(SynthesisTask::VSANode *node, int exampl
 }
 
 SynthesisTask::VSANode* SynthesisTask::initNode(int state, const StateValue& value, int example_id) {
-    std::string feature = encodeFeature(state, value);
+    return initNode(encodeKey(state, value), value, example_id);
+}
+
+SynthesisTask::VSANode* SynthesisTask::initNode(const StateKey& key, const StateValue& value, int example_id) {
+    std::lock_guard<std::recursive_mutex> vsa_guard(vsa_lock);
     auto& cache = example_id > 0 ? combined_node_map : single_node_map[-example_id];
-    auto*& result = cache[feature];
+    auto* result = cache.find(key);
     if (result != nullptr) return result;
+    int state = key.ids[0];
     auto& graph_node = graph->minimal_context_list[state];
     if (example_id <= 0) {
-        return result = new VSANode(state, value, graph_node.upper_bound);
+        result = arena.create<VSANode>(state, value, graph_node.upper_bound);
     } else {
-        auto* r = initNode(state, {value[value.size() - 1]}, -example_id);
+        StateKey l_key, r_key;
+        splitKey(key, l_key, r_key);
+        auto* r = initNode(r_key, {value[value.size() - 1]}, -example_id);
         auto _value = value; _value.pop_back();
-        auto* l = initNode(state, _value, example_id - 1);
-        return result = new VSANode(state, value, l, r, std::min(l->p, r->p));
+        auto* l = initNode(l_key, _value, example_id - 1);
+        result = arena.create<VSANode>(state, value, l, r, std::min(l->p, r->p));
     }
+    result->key = key;
+    cache.insert(key, result);
+    return result;
 }
 
-Program* SynthesisTask::synthesisProgramFromExample() {
+SharedProgram* SynthesisTask::synthesisProgramFromExample() {
     StateValue value;
     for (auto* example: example_list) {
         value.push_back({example->oup});
     }
     VSANode* node = initNode(0, value, example_list.size() - 1);
-    while (!getBestProgramWithOup(node, example_list.size() - 1, value_limit)) {
+    while (true) {
+        expand_num = 0; resume_num = 0; scan_edge_num = 0;
+        bool is_found = getBestProgramWithOup(node, example_list.size() - 1, value_limit);
+        LOG(INFO) << "Searched with the global lowerbound " << value_limit << ": " << expand_num << " nodes expanded ("
+                  << resume_num << " resumed from frontiers), " << scan_edge_num << " edges scanned" << std::endl;
+        if (is_found) break;
+        if (isCancelled()) return nullptr;
+        // Before the lowerbound is relaxed, a conditional program is tried, whose branches and guards are searched on
+        // single examples.
+        if (is_divide_mode) {
+            auto* result = synthesisProgramByDivision();
+            if (result != nullptr) return result;
+        }
         value_limit -= 3;
         if (value_limit < -1000) {
             LOG(INFO) << "No valid program found" << std::endl;
-            exit(0);
+            return nullptr;
         }
         LOG(INFO) << "Relaxed the global lowerbound to " << value_limit << std::endl;
     }
     return node->best_program;
 }
 
+SharedProgram* SynthesisTask::getBestProgramForExample(int state, const DataList& oup, int example_id, double& p) {
+    // The term is searched with the global lowerbound, so that the division is not more expensive than the normal
+    // search under the same lowerbound.
+    VSANode* node = initNode(state, {oup}, -example_id);
+    if (!getBestProgramWithOup(node, -example_id, value_limit)) return nullptr;
+    p = node->p;
+    return node->best_program;
+}
+
+void SynthesisTask::collectGuards(int state, bool value, int example_id,
+        std::vector<std::pair<double, SharedProgram*>>& result) {
+    VSANode* node = initNode(state, {{Data(value)}}, -example_id);
+    if (!node->is_build_edge) buildEdge(node, -example_id);
+    // Each edge of the VSA node gives the best guard through its operator and sub-values. Its sub-nodes are searched
+    // with the global lowerbound, and thus the collected guards are the likely ones.
+    for (auto* edge: node->edge_list) {
+        if (edge->w < value_limit || std::find(edge->v.begin(), edge->v.end(), node) != edge->v.end()) continue;
+        std::vector<SharedProgram*> sub_program;
+        for (auto* sub_node: edge->v) {
+            if (!getBestProgramWithOup(sub_node, -example_id, value_limit)) break;
+            sub_program.push_back(sub_node->best_program);
+        }
+        if (sub_program.size() < edge->v.size()) continue;
+        result.emplace_back(edge->updateW(), program_pool.getProgram(edge->semantics, sub_program));
+    }
+}
+
+SharedProgram* SynthesisTask::synthesisProgramByDivision() {
+    MinimalContextGraph::Edge* ite_edge = nullptr;
+    for (auto* edge: graph->minimal_context_list[0].edge_list) {
+        if (edge->rule->semantics->name == "ite") ite_edge = edge;
+    }
+    if (ite_edge == nullptr) return nullptr;
+    int example_num = example_list.size();
+    // The terms are the best programs on single examples in the context of the branches of "ite", which reuse the VSAs
+    // in "single_node_map". A new term is synthesized only for examples not covered by previous terms, so that fewer
+    // and more general terms are preferred.
+    std::vector<SharedProgram*> term_list;
+    std::vector<double> term_p;
+    std::vector<std::vector<bool>> term_cover;
+    for (int i = 0; i < example_num; ++i) {
+        bool is_covered = false;
+        for (auto& cover: term_cover) is_covered |= cover[i];
+        if (is_covered) continue;
+        double p;
+        auto* term = getBestProgramForExample(ite_edge->v[1], {example_list[i]->oup}, i, p);
+        if (term == nullptr) return nullptr;
+        std::vector<bool> cover(example_num);
+        for (int j = 0; j < example_num; ++j) {
+            cover[j] = term->run(param_info_list[j], j, &example_cache) == example_list[j]->oup;
+        }
+        term_list.push_back(term);
+        term_p.push_back(p);
+        term_cover.push_back(cover);
+    }
+    DivisionInfo info;
+    std::vector<bool> is_used(term_list.size(), false), is_covered(example_num, false);
+    info.label_list.resize(example_num);
+    while (info.term_list.size() < term_list.size()) {
+        int best_term = -1, best_num = -1;
+        for (int i = 0; i < term_list.size(); ++i) {
+            if (is_used[i]) continue;
+            int num = 0;
+            for (int j = 0; j < example_num; ++j) num += term_cover[i][j] && !is_covered[j];
+            if (num > best_num || (num == best_num && term_p[i] > term_p[best_term])) {
+                best_term = i; best_num = num;
+            }
+        }
+        is_used[best_term] = true;
+        for (int j = 0; j < example_num; ++j) {
+            if (term_cover[best_term][j] && !is_covered[j]) {
+                is_covered[j] = true;
+                info.label_list[j] = info.term_list.size();
+            }
+        }
+        info.term_list.push_back(term_list[best_term]);
+        info.term_cover.push_back(term_cover[best_term]);
+    }
+    // The guards are collected from the conditions of "ite" that are true or false on single examples.
+    std::vector<std::pair<double, SharedProgram*>> guard_list;
+    for (int i = 0; i < example_num; ++i) {
+        for (bool value: {true, false}) {
+            collectGuards(ite_edge->v[0], value, i, guard_list);
+        }
+    }
+    std::unordered_set<SharedProgram*> guard_set;
+    for (auto& guard_info: guard_list) {
+        auto* guard = guard_info.second;
+        if (!guard_set.insert(guard).second) continue;
+        std::vector<bool> guard_value(example_num);
+        for (int j = 0; j < example_num; ++j) {
+            guard_value[j] = guard->run(param_info_list[j], j, &example_cache).getBool();
+        }
+        info.guard_list.push_back(guard);
+        info.guard_value.push_back(guard_value);
+        info.guard_p.push_back(guard_info.first);
+    }
+    std::vector<int> id_list(example_num);
+    for (int i = 0; i < example_num; ++i) id_list[i] = i;
+    auto* result = learnDecisionTree(id_list, info, ite_edge->rule->semantics, program_pool);
+    LOG(INFO) << "Divided " << example_num << " examples with " << info.term_list.size() << " terms and "
+              << info.guard_list.size() << " guards: " << (result == nullptr ? "failed" : "succeeded") << std::endl;
+    // A single term is left to the normal search, which ranks it in the context of the start symbol.
+    if (result == nullptr || std::find(term_list.begin(), term_list.end(), result) != term_list.end()) return nullptr;
+    // As with the normal search, a program less likely than the global lowerbound is not accepted, so that it cannot
+    // shadow a more likely program found after the lowerbound is relaxed.
+    double probability = calculateProbability(0, result);
+    if (probability < value_limit) {
+        LOG(INFO) << "Rejected the divided program with log-prob " << probability << std::endl;
+        return nullptr;
+    }
+    return result;
+}
+
+void SynthesisTask::releaseSearchSpace() {
+    auto& slab_list = arena.getSlabList();
+#ifdef DEBUG
+    for (int i = 0; i < slab_list.size(); ++i) {
+        std::cout << "Slab " << i << ": " << slab_list[i].used << " bytes, " << slab_list[i].object_num << " objects" << std::endl;
+    }
+#endif
+    LOG(INFO) << "Released " << arena.getAllocatedBytes() << " bytes, " << arena.getObjectNum() << " objects in "
+              << slab_list.size() << " slabs, " << program_pool.size() << " shared programs" << std::endl;
+    LOG(INFO) << "Evaluation cache: " << example_cache.getHitNum() << " hits, " << example_cache.getMissNum()
+              << " misses (hit rate " << example_cache.getHitRate() << ") on examples; " << verify_cache.getHitNum()
+              << " hits, " << verify_cache.getMissNum() << " misses (hit rate " << verify_cache.getHitRate()
+              << ") in verification" << std::endl;
+    combined_node_map.clear();
+    single_node_map.clear();
+    example_list.clear();
+    param_info_list.clear();
+    example_cache.clear();
+    verify_cache.clear();
+    arena.release();
+    program_pool.clear();
+}
+
 Program * SynthesisTask::solve() {
 #ifdef DEBUG
     std::cout << "Start synthesis" << std::endl;
@@ -344,17 +779,25 @@ Program * SynthesisTask::solve() {
     addNewExample(spec->example_space[0]);
     LOG(INFO) << "New example: " << spec->example_space[0]->toString() << std::endl;
     while (1) {
-        Program* result = synthesisProgramFromExample();
+        SharedProgram* result = synthesisProgramFromExample();
+        if (result == nullptr) {
+            if (isCancelled()) LOG(INFO) << "Cancelled" << std::endl;
+            releaseSearchSpace();
+            return nullptr;
+        }
         LOG(INFO) << "Program: " << result->toString() << "; Log-prob: " << calculateProbability(0, result) << std::endl;
         for (int i = 0; i < example_list.size(); ++i) {
 #ifdef DEBUG
             std::cout << util::dataList2String(example_list[i]->inp) << " " << example_list[i]->oup.toString() << " " << result->run(example_list[i]->inp).toString() << std::endl;
 #endif
-            assert(result->run(example_list[i]->inp) == example_list[i]->oup);
+            assert(result->run(param_info_list[i], i, &example_cache) == example_list[i]->oup);
         }
         Example* counter_example = nullptr;
-        if (spec->verify(result, counter_example)) {
-            return result;
+        if (spec->verify(result, counter_example, &verify_cache)) {
+            // The result is expanded into an AST before the shared programs are released.
+            auto* final_result = result->toProgram();
+            releaseSearchSpace();
+            return final_result;
         }
 #ifdef DEBUG
         assert(counter_example != nullptr);
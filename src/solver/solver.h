@@ -5,9 +5,33 @@
 #include "context_maintainer.h"
 #include "specification.h"
 #include "minimal_context_graph.h"
+#include "state_table.h"
+#include "arena.h"
+
+#include <atomic>
+#include <mutex>
 
 typedef std::vector<DataList> StateValue;
 
+// A field of the VSA which may be read and written by several search threads at the same time.
+// Every value ever stored is valid on its own (e.g., an upper bound of a probability), so plain acquire/release
+// accesses are enough, and they compile to ordinary loads and stores on common platforms.
+template<class T>
+class SharedValue {
+    std::atomic<T> value;
+public:
+    SharedValue(T _value): value(_value) {}
+    operator T() const {return value.load(std::memory_order_acquire);}
+    SharedValue& operator = (T _value) {
+        value.store(_value, std::memory_order_release);
+        return *this;
+    }
+    // Store "_value" only if the current value is "expected". Return whether the value is stored.
+    bool compareAndSet(T expected, T _value) {
+        return value.compare_exchange_strong(expected, _value, std::memory_order_acq_rel);
+    }
+};
+
 // The main solver. It does not use any domain knowledge, and thus this part remains unchanged for different domains.
 class SynthesisTask {
 public:
@@ -16,16 +40,28 @@ public:
     struct VSAEdge {
         Semantics* semantics;
         std::vector<VSANode*> v;
-        double w, rule_w;
-        VSAEdge(const std::vector<VSANode*>& _v, Semantics* _semantics, double _rule_w): semantics(_semantics), rule_w(_rule_w), v(_v) {
+        SharedValue<double> w;
+        double rule_w;
+        VSAEdge(const std::vector<VSANode*>& _v, Semantics* _semantics, double _rule_w): semantics(_semantics), w(_rule_w), rule_w(_rule_w), v(_v) {
             updateW();
         }
         double updateW() {
-            w = rule_w;
+            double new_w = rule_w;
             for (auto* sub_node: v) {
-                w += sub_node->p;
+                new_w += sub_node->p;
             }
-            return w;
+            w = new_w;
+            return new_w;
+        }
+        // The same as "updateW", except that the probability of "node" is taken as "node_p". It is used when the
+        // new probability of "node" is still being computed and thus cannot be published yet.
+        double updateW(VSANode* node, double node_p) {
+            double new_w = rule_w;
+            for (auto* sub_node: v) {
+                new_w += sub_node == node ? node_p : double(sub_node->p);
+            }
+            w = new_w;
+            return new_w;
         }
         void print();
     };
@@ -34,51 +70,105 @@ public:
         std::vector<VSAEdge*> edge_list;
         int state;
         StateValue value;
-        Program* best_program;
+        StateKey key;
+        SharedValue<SharedProgram*> best_program;
         VSANode *l, *r;
-        double p;
-        bool is_build_edge;
+        SharedValue<double> p;
+        // "edge_list" is complete and immutable once "is_build_edge" is set. "build_lock" guards the building.
+        SharedValue<bool> is_build_edge;
+        std::mutex build_lock;
+        // The edges left when a search on this node fails, as a max-heap of (the weight when the edge is recorded,
+        // the index of the edge in "edge_list"). Weights only decrease, so a search with a relaxed limit only needs
+        // to resume from the top of the heap. "is_frontier_busy" is set while a search is using the heap, and
+        // "frontier_epoch" is the epoch of the task when the heap is recorded.
+        std::vector<std::pair<double, int>> frontier;
+        SharedValue<int> frontier_epoch;
+        SharedValue<bool> has_frontier, is_frontier_busy;
         VSANode(int _state, const StateValue& _value, double _p):
-            state(_state), value(_value), best_program(nullptr), p(_p), is_build_edge(false), l(nullptr), r(nullptr) {}
+            state(_state), value(_value), best_program(nullptr), p(_p), is_build_edge(false), l(nullptr), r(nullptr),
+            frontier_epoch(0), has_frontier(false), is_frontier_busy(false) {}
         VSANode(int _state, const StateValue& _value, VSANode* _l, VSANode* _r, double _p):
-                state(_state), value(_value), best_program(nullptr), p(_p), is_build_edge(false), l(_l), r(_r) {}
+                state(_state), value(_value), best_program(nullptr), p(_p), is_build_edge(false), l(_l), r(_r),
+                frontier_epoch(0), has_frontier(false), is_frontier_busy(false) {}
         double updateP() {
+            double new_p;
             if (!is_build_edge) {
-                return p = std::min(l->p, r->p);
+                new_p = std::min<double>(l->p, r->p);
+            } else {
+                new_p = -1e100;
+                for (auto *edge: edge_list) new_p = std::max(new_p, edge->updateW(this, new_p));
+                if (l) {
+                    new_p = std::min(std::min<double>(l->p, r->p), new_p);
+                }
             }
-            p = -1e100;
-            for (auto *edge: edge_list) p = std::max(p, edge->updateW());
-            if (l) {
-                p = std::min(std::min(l->p, r->p), p);
-            }
-            return p;
+            p = new_p;
+            return new_p;
         }
         void print();
     };
 
 private:
+    // All VSA nodes and VSA edges of the current call of "solve" are allocated in this arena.
+    Arena arena;
+    // The best programs of VSA nodes, shared across nodes.
+    SharedProgramPool program_pool;
+    // Guards the arena and the node tables when the search runs on several threads.
+    std::recursive_mutex vsa_lock;
     std::vector<Example*> example_list;
     std::vector<ParamInfo*> param_info_list;
-    std::unordered_map<std::string, VSANode*> combined_node_map;
-    std::vector<std::unordered_map<std::string, VSANode*>> single_node_map;
+    StateTable<VSANode> combined_node_map;
+    std::vector<StateTable<VSANode>> single_node_map;
+    // The outputs of shared programs on the examples in "example_list" and on the examples of "spec" respectively.
+    EvaluationCache example_cache, verify_cache;
+    // Statistics of the current search: the number of expanded nodes, the number of them resumed from a frontier,
+    // and the number of edges scanned on all expanded nodes.
+    std::atomic<long long> expand_num, resume_num, scan_edge_num;
+    // Bumped whenever the upperbound of a node is raised, which invalidates all recorded frontiers.
+    std::atomic<int> frontier_epoch;
 
-    Program* synthesisProgramFromExample();
+    SharedProgram* synthesisProgramFromExample();
+    SharedProgram* synthesisProgramByDivision();
+    SharedProgram* getBestProgramForExample(int state, const DataList& oup, int example_id, double& p);
+    void collectGuards(int state, bool value, int example_id, std::vector<std::pair<double, SharedProgram*>>& result);
     Program* getBestProgramWithoutOup(int state);
     void verifyResult(int start_state, VSANode *result);
     void verifyExampleResult(VSANode* node, int example_id);
     bool getBestProgramWithOup(VSANode* node, int example_id, double limit);
+    void searchEdgeInParallel(VSAEdge* edge, int example_id, std::atomic<double>& shared_limit);
+    bool acquireFrontier(VSANode* node);
+    double getFrontierTop(VSANode* node);
+    double updatePFromFrontier(VSANode* node);
+    void recordFrontier(VSANode* node, const std::vector<int>& edge_id_list);
     VSANode* initNode(int state, const StateValue& value, int example_id);
+    VSANode* initNode(const StateKey& key, const StateValue& value, int example_id);
     void addNewExample(Example* example);
     void buildEdge(VSANode* node, int example_id);
+    void releaseSearchSpace();
+    bool isCancelled() const {return cancel_flag != nullptr && *cancel_flag;}
 public:
     MinimalContextGraph* graph;
     Specification* spec;
     double value_limit;
+    // Whether to explore different candidate edges of the top-down search as parallel tasks on "global::thread_pool".
+    bool is_parallel_search;
+    // Whether to synthesize programs whose start symbol has an "ite" rule by divide and conquer: terms are synthesized
+    // for single examples, and a decision tree over guards is learned to select among them.
+    bool is_divide_mode;
+    // If it is set by another thread, the search stops as soon as possible and "solve" returns nullptr.
+    const std::atomic<bool>* cancel_flag;
 
-    double calculateProbability(int state, Program* program);
-    SynthesisTask(MinimalContextGraph* _graph, Specification* _spec): graph(_graph), spec(_spec), value_limit(-5) {
+    double calculateProbability(int state, SharedProgram* program);
+    SynthesisTask(MinimalContextGraph* _graph, Specification* _spec): graph(_graph), spec(_spec), value_limit(-5), is_parallel_search(false), is_divide_mode(false), cancel_flag(nullptr),
+        expand_num(0), resume_num(0), scan_edge_num(0), frontier_epoch(0), example_cache(1 << 16), verify_cache(1 << 16) {
+    }
+    // Limit the number of entries in each evaluation cache. 0 disables the caches.
+    void setEvalCacheSize(size_t size) {
+        example_cache.setCapacity(size);
+        verify_cache.setCapacity(size);
     }
 
+    // Return nullptr if no program is found before the global lowerbound drops below -1000, or if the task is
+    // cancelled through "cancel_flag".
     Program* solve();
 };
 #endif //L2S_SOLVER_H
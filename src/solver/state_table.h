@@ -0,0 +1,93 @@
+#ifndef L2S_STATE_TABLE_H
+#define L2S_STATE_TABLE_H
+
+#include <vector>
+#include <cstddef>
+
+// The interned form of a VSA node: the state followed by, for each example, the number of values in its DataList
+// and the ids of these values in the data pool of "global::context". The hash is computed once when the key is built.
+struct StateKey {
+    std::vector<int> ids;
+    size_t hash;
+    StateKey(): hash(14695981039346656037ull) {}
+    void push(int id) {
+        ids.push_back(id);
+        hash = (hash ^ size_t(id)) * 1099511628211ull;
+    }
+};
+
+// A flat open-addressing hash table from keys of VSA nodes to VSA nodes.
+// All keys are stored in one contiguous buffer, so that neither lookups nor insertions allocate per key.
+template<class T>
+class StateTable {
+    struct Slot {
+        size_t hash;
+        int pos, len;
+        T* value;
+        Slot(): hash(0), pos(0), len(-1), value(nullptr) {}
+    };
+    std::vector<Slot> slot_list;
+    std::vector<int> key_buffer;
+    int num;
+
+    // The low bits of a multiplicative hash depend only on the low bits of the ids, so fold the high bits in.
+    size_t start(size_t hash, size_t mask) const {
+        return (hash ^ (hash >> 29)) & mask;
+    }
+
+    bool match(const Slot& slot, const StateKey& key) const {
+        if (slot.hash != key.hash || slot.len != key.ids.size()) return false;
+        for (int i = 0; i < slot.len; ++i) {
+            if (key_buffer[slot.pos + i] != key.ids[i]) return false;
+        }
+        return true;
+    }
+
+    void rehash() {
+        std::vector<Slot> old_list(slot_list.size() * 2);
+        old_list.swap(slot_list);
+        size_t mask = slot_list.size() - 1;
+        for (auto& slot: old_list) {
+            if (slot.len < 0) continue;
+            size_t pos = start(slot.hash, mask);
+            while (slot_list[pos].len >= 0) pos = (pos + 1) & mask;
+            slot_list[pos] = slot;
+        }
+    }
+
+public:
+    StateTable(): slot_list(16), num(0) {}
+
+    T* find(const StateKey& key) const {
+        size_t mask = slot_list.size() - 1;
+        for (size_t pos = start(key.hash, mask); slot_list[pos].len >= 0; pos = (pos + 1) & mask) {
+            if (match(slot_list[pos], key)) return slot_list[pos].value;
+        }
+        return nullptr;
+    }
+
+    // "key" must not be in the table yet.
+    void insert(const StateKey& key, T* value) {
+        if ((num + 1) * 2 > slot_list.size()) rehash();
+        size_t mask = slot_list.size() - 1;
+        size_t pos = start(key.hash, mask);
+        while (slot_list[pos].len >= 0) pos = (pos + 1) & mask;
+        Slot& slot = slot_list[pos];
+        slot.hash = key.hash;
+        slot.pos = key_buffer.size();
+        slot.len = key.ids.size();
+        slot.value = value;
+        key_buffer.insert(key_buffer.end(), key.ids.begin(), key.ids.end());
+        ++num;
+    }
+
+    int size() const {return num;}
+
+    void clear() {
+        slot_list.assign(16, Slot());
+        key_buffer.clear();
+        num = 0;
+    }
+};
+
+#endif //L2S_STATE_TABLE_H
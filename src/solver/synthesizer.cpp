@@ -0,0 +1,155 @@
+#include "synthesizer.h"
+#include "specification_parser.h"
+#include "solver.h"
+#include "matrix_operator.h"
+#include "string_index.h"
+#include "constant_classifier.h"
+#include "config.h"
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <ctime>
+#include <thread>
+#include <glog/logging.h>
+
+Specification* synthesizer::loadTask(const std::string& spec_file, const std::string& benchmark_type) {
+    global::context->isMatrix = benchmark_type == "matrix";
+    LOG(INFO) << "Parsing the specification from " << spec_file << " with type " << benchmark_type << std::endl;
+    Specification* spec = parser::loadSpecification(spec_file, benchmark_type);
+    if (spec == nullptr) {
+        LOG(ERROR) << "Failed to parse " << spec_file << std::endl;
+        return nullptr;
+    }
+    LOG(INFO) << "Finished. Example num: " << spec->example_space.size() << std::endl;
+
+    if (global::context->isMatrix) {
+        LOG(INFO) << "Building the table of matrix shapes" << std::endl;
+        auto table_start_time = clock();
+        std::vector<int> size_list;
+        for (auto* example: spec->example_space) {
+            for (auto& inp: example->inp) {
+                if (inp.getType() == TMATRIX) size_list.push_back(inp.getMatrix().size());
+            }
+            if (example->oup.getType() == TMATRIX) size_list.push_back(example->oup.getMatrix().size());
+        }
+        auto* shape_table = new ShapeTable(size_list, global::context->string_info->int_const, global::context->KMaxDim);
+        global::context->string_info->shape_table = std::shared_ptr<const ShapeTable>(shape_table);
+        LOG(INFO) << "Finished. Size num: " << shape_table->getSizeNum() << ", shape num: " << shape_table->getShapeNum()
+                  << ", time cost: " << (clock() - table_start_time) * 1.0 / CLOCKS_PER_SEC << std::endl;
+    } else {
+        LOG(INFO) << "Building the substring index of strings" << std::endl;
+        auto index_start_time = clock();
+        DataList string_list = global::context->string_info->const_list;
+        for (auto* example: spec->example_space) {
+            for (auto& inp: example->inp) string_list.push_back(inp);
+            string_list.push_back(example->oup);
+        }
+        auto* string_index = new StringIndex(string_list);
+        global::context->string_info->string_index = std::shared_ptr<const StringIndex>(string_index);
+        LOG(INFO) << "Finished. String num: " << string_index->size() << ", time cost: "
+                  << (clock() - index_start_time) * 1.0 / CLOCKS_PER_SEC << std::endl;
+
+        LOG(INFO) << "Classifying string constants" << std::endl;
+        auto classify_start_time = clock();
+        auto* classifier = new ConstantClassifier(global::context->string_info->const_list, spec->example_space);
+        global::context->string_info->const_classifier = std::shared_ptr<const ConstantClassifier>(classifier);
+        LOG(INFO) << "Finished. Constant num: " << classifier->size() << ", time cost: "
+                  << (clock() - classify_start_time) * 1.0 / CLOCKS_PER_SEC << std::endl;
+    }
+    return spec;
+}
+
+ContextInfoMap* synthesizer::loadModel(const std::string& model_file) {
+    LOG(INFO) << "Parsing the topdown prediction model from " << model_file << std::endl;
+    auto* info_map = new ContextInfoMap(model_file);
+    LOG(INFO) << "Finished. Context num: " << info_map->size() << std::endl;
+    return info_map;
+}
+
+MinimalContextGraph* synthesizer::buildGraph(Specification* spec, ContextInfoMap* info_map) {
+    LOG(INFO) << "Building the transition graph of contexts and calculating the initial heuristic value" << std::endl;
+    auto* graph = new MinimalContextGraph(spec->start_terminal, new TopDownContextMaintainer(), info_map);
+    LOG(INFO) << "Finished" << std::endl;
+    return graph;
+}
+
+Program* synthesizer::synthesize(MinimalContextGraph* graph, Specification* spec, const SynthesisOption& option,
+        double& time_cost) {
+    LOG(INFO) << "Synthesizing" << std::endl;
+    auto start_time = clock();
+    SynthesisTask task(graph, spec);
+    task.is_parallel_search = option.is_parallel_search;
+    task.is_divide_mode = option.is_divide_mode;
+    task.value_limit = option.value_limit;
+    task.setEvalCacheSize(option.eval_cache_size);
+    auto* result = task.solve();
+    time_cost = (clock() - start_time) * 1.0 / CLOCKS_PER_SEC;
+    if (result != nullptr) LOG(INFO) << "Result: " << result->toString() << std::endl;
+    LOG(INFO) << "Time Cost: " << time_cost << std::endl;
+    return result;
+}
+
+Program* synthesizer::solvePortfolio(Specification *spec, const std::vector<PortfolioConfig> &config_list, int &winner,
+        double &time_cost) {
+    auto start_time = std::chrono::steady_clock::now();
+    SolverContext* task_context = global::context;
+    std::atomic<bool> is_finished(false);
+    std::atomic<int> winner_id(-1);
+    std::vector<Program*> result_list(config_list.size(), nullptr);
+    std::vector<std::thread> thread_list;
+    for (int i = 0; i < config_list.size(); ++i) {
+        thread_list.emplace_back([&, i]() {
+            auto& config = config_list[i];
+            SolverContext context;
+            context.copyTaskFrom(*task_context);
+            SolverContextGuard guard(&context);
+            context.KContextDepth = config.info_map->context_depth;
+            context.KDefaultP = config.default_p;
+            // The graph of each configuration is freed with its thread, whether the configuration wins or not.
+            std::unique_ptr<TopDownContextMaintainer> maintainer(new TopDownContextMaintainer());
+            std::unique_ptr<MinimalContextGraph> graph(
+                    new MinimalContextGraph(spec->start_terminal, maintainer.get(), config.info_map));
+            SynthesisTask task(graph.get(), spec);
+            task.is_parallel_search = config.option.is_parallel_search;
+            task.is_divide_mode = config.option.is_divide_mode;
+            task.value_limit = config.option.value_limit;
+            task.setEvalCacheSize(config.option.eval_cache_size);
+            task.cancel_flag = &is_finished;
+            result_list[i] = task.solve();
+            int expected = -1;
+            if (result_list[i] != nullptr && winner_id.compare_exchange_strong(expected, i)) {
+                is_finished = true;
+                LOG(INFO) << "Configuration " << config.name << " finished first" << std::endl;
+            }
+        });
+    }
+    for (auto& thread: thread_list) thread.join();
+    time_cost = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count();
+    winner = winner_id;
+    // Configurations finishing after the winner are not cancelled in time, and their results are dropped.
+    for (int i = 0; i < result_list.size(); ++i) {
+        if (i != winner) delete result_list[i];
+    }
+    if (winner == -1) {
+        LOG(INFO) << "No configuration found a valid program" << std::endl;
+        return nullptr;
+    }
+    LOG(INFO) << "Result: " << result_list[winner]->toString() << std::endl;
+    LOG(INFO) << "Time Cost: " << time_cost << std::endl;
+    return result_list[winner];
+}
+
+Program* synthesizer::solve(const std::string& spec_file, const std::string& benchmark_type, ContextInfoMap* info_map,
+        const SynthesisOption& option, double& time_cost) {
+    SolverContext context;
+    SolverContextGuard guard(&context);
+    context.KContextDepth = info_map->context_depth;
+    auto* spec = loadTask(spec_file, benchmark_type);
+    if (spec == nullptr) {
+        time_cost = 0;
+        return nullptr;
+    }
+    auto* graph = buildGraph(spec, info_map);
+    return synthesize(graph, spec, option, time_cost);
+}
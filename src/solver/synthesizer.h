@@ -0,0 +1,51 @@
+#ifndef L2S_SYNTHESIZER_H
+#define L2S_SYNTHESIZER_H
+
+#include "context.h"
+#include "specification.h"
+#include "minimal_context_graph.h"
+
+// The options of a synthesis task. See the flags of "run" for their meanings.
+struct SynthesisOption {
+    bool is_parallel_search = false;
+    bool is_divide_mode = false;
+    size_t eval_cache_size = 1 << 16;
+    // The initial global lowerbound of the log-probability of the result program.
+    double value_limit = -5;
+};
+
+// A configuration in a portfolio. The depth of contexts follows the model.
+struct PortfolioConfig {
+    std::string name;
+    ContextInfoMap* info_map;
+    double default_p;
+    SynthesisOption option;
+};
+
+// The interface for embedding the synthesizer. All steps work on "global::context": a task is solved on one thread
+// with its own context, and tasks with different contexts can be solved at the same time. Models are only read
+// during synthesis and thus can be shared among these tasks.
+namespace synthesizer {
+    // Parse the specification and build the data shared by all examples on the string info of the context. Return
+    // nullptr if the specification cannot be parsed.
+    extern Specification* loadTask(const std::string& spec_file, const std::string& benchmark_type);
+    extern ContextInfoMap* loadModel(const std::string& model_file);
+    extern MinimalContextGraph* buildGraph(Specification* spec, ContextInfoMap* info_map);
+    // Synthesize a program for "spec", or return nullptr if there is none within the bounds of the search.
+    // "time_cost" is set to the CPU time of synthesis in seconds.
+    extern Program* synthesize(MinimalContextGraph* graph, Specification* spec, const SynthesisOption& option,
+            double& time_cost);
+    // Solve the task loaded in the current context with all configurations at the same time, each on its own thread
+    // and in its own context. The specification, the string info and the semantics are shared. Once a configuration
+    // returns a verified program, the others are cancelled. "winner" is set to the index of the configuration that found
+    // the result, and "time_cost" to the wall-clock time in seconds. If no configuration finds a program, the result is
+    // nullptr and "winner" is -1.
+    extern Program* solvePortfolio(Specification* spec, const std::vector<PortfolioConfig>& config_list, int& winner,
+            double& time_cost);
+    // Solve a task from scratch with a new context on the current thread. Return nullptr if the specification cannot be
+    // parsed or no program is found.
+    extern Program* solve(const std::string& spec_file, const std::string& benchmark_type, ContextInfoMap* info_map,
+            const SynthesisOption& option, double& time_cost);
+}
+
+#endif //L2S_SYNTHESIZER_H